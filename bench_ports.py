@@ -0,0 +1,292 @@
+#!/usr/bin/env python3
+"""
+Benchmark the solver ports against each other on the same puzzles.
+
+Each port (C++ in cplusplus/, Rust in rust/, Go in golang/ and the Python
+solve_puzzles.py) is built or located, then run with -v on the same slice
+of each corpus file with the same solver and tier settings. The harness
+checks that status, solution and work score agree per puzzle with the
+first port listed, and reports throughput and latency side by side.
+
+Throughput is puzzles per second of wall time for one process solving the
+whole slice (best of --repeat runs). With --latency, every puzzle is also
+solved in its own process; the reported per-puzzle latencies (median, p95,
+max) then include process startup, which the "startup" column measures on
+a one-puzzle run of test_sample.txt.
+
+Usage:
+    python bench_ports.py [options] <corpus_file> [<corpus_file> ...]
+
+Example:
+    python bench_ports.py -s BF -n 200 testsuites/GEN_9x8_testsuite.txt testsuites/PS_testsuite.txt
+    python bench_ports.py -p cpp,go --latency -n 50 testsuites/PS_testsuite.txt
+"""
+
+import argparse
+import os
+import shutil
+import statistics
+import subprocess
+import sys
+import time
+
+from slants_board import parse_puzzle_line
+
+ROOT = os.path.dirname(os.path.abspath(__file__))
+SAMPLE_FILE = os.path.join(ROOT, 'testsuites', 'test_sample.txt')
+ALL_PORTS = ['cpp', 'rust', 'go', 'python']
+
+
+def locate_port(port, build):
+    """
+    Find (and with build, first build) the solver for a port.
+
+    Returns (command_prefix, None) or (None, reason) if it is unavailable.
+    """
+    if port == 'cpp':
+        directory = os.path.join(ROOT, 'cplusplus')
+        binary = os.path.join(directory, 'solve_puzzles')
+        build_cmd = ['make', '-C', directory]
+    elif port == 'rust':
+        directory = os.path.join(ROOT, 'rust')
+        binary = os.path.join(directory, 'target', 'release', 'solve_puzzles')
+        build_cmd = ['cargo', 'build', '--release', '--bin', 'solve_puzzles',
+                     '--manifest-path', os.path.join(directory, 'Cargo.toml')]
+    elif port == 'go':
+        directory = os.path.join(ROOT, 'golang')
+        binary = os.path.join(directory, 'solve_puzzles')
+        build_cmd = ['go', 'build', '-C', directory, '-o', 'solve_puzzles', '.']
+    elif port == 'python':
+        interpreter = shutil.which('pypy3') or sys.executable
+        return [interpreter, os.path.join(ROOT, 'solve_puzzles.py')], None
+    else:
+        return None, f"unknown port '{port}'"
+
+    if build:
+        if not shutil.which(build_cmd[0]):
+            return None, f"{build_cmd[0]} not found"
+        result = subprocess.run(build_cmd, capture_output=True, text=True)
+        if result.returncode != 0:
+            last_line = (result.stderr.strip().splitlines() or ['build failed'])[-1]
+            return None, f"build failed: {last_line}"
+    if not os.path.isfile(binary):
+        return None, f"{os.path.relpath(binary, ROOT)} not built (use --build)"
+    return [binary], None
+
+
+def parse_result_line(line):
+    """
+    Parse one -v output line into (name, status, solution, work_score).
+
+    The ports append work_score= (and status= when unsolved) after any
+    comment already in the record, so the last occurrence of each wins.
+    Returns None for summary and other non-record lines.
+    """
+    if not line or line.startswith('#'):
+        return None
+    parts = line.split('\t')
+    if len(parts) < 6:
+        return None
+    solution = parts[4]
+    status = 'solved' if solution else 'unsolved'
+    work_score = None
+    for token in parts[5].lstrip('#').split():
+        if token.startswith('work_score='):
+            work_score = int(token.split('=', 1)[1])
+        elif token.startswith('status='):
+            status = token.split('=', 1)[1]
+    return parts[0], status, solution, work_score
+
+
+def run_port(command, corpus, args, offset=None, count=None, timeout=None):
+    """
+    Run a port with -v on a slice of corpus.
+
+    Returns (elapsed_seconds, {name: (status, solution, work_score)}, error).
+    """
+    cmd = command + ['-v', '-s', args.solver, '-mt', str(args.max_tier),
+                     '-ofst', str(offset if offset is not None else args.ofst)]
+    count = count if count is not None else args.n
+    if count:
+        cmd += ['-n', str(count)]
+    if args.filter:
+        cmd += ['-f', args.filter]
+    cmd.append(corpus)
+
+    start = time.perf_counter()
+    try:
+        result = subprocess.run(cmd, capture_output=True, text=True, timeout=timeout)
+    except subprocess.TimeoutExpired:
+        return None, {}, 'timeout'
+    elapsed = time.perf_counter() - start
+    if result.returncode != 0:
+        return elapsed, {}, f"exit status {result.returncode}"
+
+    records = {}
+    for line in result.stdout.splitlines():
+        parsed = parse_result_line(line)
+        if parsed:
+            name, status, solution, work_score = parsed
+            records[name] = (status, solution, work_score)
+    return elapsed, records, None
+
+
+def measure_latency(command, corpus, args, num_records):
+    """Solve each record of the slice in its own process and return the wall times."""
+    times = []
+    for i in range(num_records):
+        elapsed, records, error = run_port(command, corpus, args, offset=args.ofst + i, count=1,
+                                           timeout=args.timeout)
+        if error or not records:
+            continue
+        times.append(elapsed)
+    return times
+
+
+def compare_records(reference, records):
+    """Return a list of (name, field, expected, got) disagreements with the reference port."""
+    field_names = ('status', 'solution', 'work_score')
+    mismatches = []
+    for name, expected in reference.items():
+        got = records.get(name)
+        if got is None:
+            mismatches.append((name, 'missing', '', ''))
+            continue
+        for field, want, have in zip(field_names, expected, got):
+            if want != have:
+                mismatches.append((name, field, want, have))
+                break
+    return mismatches
+
+
+def percentile(values, fraction):
+    """Nearest-rank percentile of a non-empty list."""
+    ordered = sorted(values)
+    index = min(len(ordered) - 1, max(0, int(round(fraction * len(ordered))) - 1))
+    return ordered[index]
+
+
+def format_ms(seconds):
+    return f"{seconds * 1000:.1f}ms" if seconds is not None else '-'
+
+
+def count_records(corpus, args):
+    """Number of records of corpus the ports will solve with these arguments."""
+    names = []
+    with open(corpus) as f:
+        for line in f:
+            puzzle = parse_puzzle_line(line)
+            if puzzle and (not args.filter or args.filter in puzzle['name']):
+                names.append(puzzle['name'])
+    names = names[max(0, args.ofst - 1):]
+    if args.n:
+        names = names[:args.n]
+    return len(names)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Benchmark the C++, Rust, Go and Python solver ports on the same puzzles'
+    )
+    parser.add_argument('corpus', nargs='+', help='Puzzle files to run')
+    parser.add_argument('-p', '--ports', type=str, default=','.join(ALL_PORTS),
+                        help='Comma-separated ports to run; the first is the reference '
+                             f'(default: {",".join(ALL_PORTS)})')
+    parser.add_argument('-s', '--solver', type=str, default='BF', choices=['PR', 'BF'],
+                        help='Solver to use in every port (default: BF)')
+    parser.add_argument('-mt', '--max_tier', type=int, default=10,
+                        help='Maximum rule tier to use in every port')
+    parser.add_argument('-f', '--filter', type=str, default=None,
+                        help='Filter puzzles by partial name match')
+    parser.add_argument('-n', type=int, default=0,
+                        help='Maximum number of puzzles per corpus file (0 = all)')
+    parser.add_argument('-ofst', type=int, default=1,
+                        help='Puzzle number to start at (1-based, default: 1)')
+    parser.add_argument('--repeat', type=int, default=3,
+                        help='Runs per port and corpus; the fastest is reported (default: 3)')
+    parser.add_argument('--timeout', type=float, default=600,
+                        help='Seconds before a port run is abandoned (default: 600)')
+    parser.add_argument('--latency', action='store_true',
+                        help='Also solve each puzzle in its own process and report latencies')
+    parser.add_argument('--build', action='store_true',
+                        help='Build the compiled ports before running')
+    parser.add_argument('--show', type=int, default=5,
+                        help='Mismatches to print per port and corpus (default: 5)')
+
+    args = parser.parse_args()
+
+    ports = []
+    for port in args.ports.split(','):
+        command, reason = locate_port(port.strip(), args.build)
+        if command is None:
+            print(f"Skipping {port}: {reason}")
+        else:
+            ports.append((port.strip(), command))
+    if not ports:
+        print("No ports available")
+        return 1
+
+    startup = {}
+    if args.latency:
+        for port, command in ports:
+            sample_args = argparse.Namespace(**vars(args))
+            sample_args.filter = None
+            elapsed, _, error = run_port(command, SAMPLE_FILE, sample_args, offset=1, count=1,
+                                         timeout=args.timeout)
+            startup[port] = None if error else elapsed
+
+    any_mismatch = False
+    for corpus in args.corpus:
+        num_records = count_records(corpus, args)
+        print(f"\n{corpus}: {num_records} puzzles, solver {args.solver}"
+              + (f", max tier {args.max_tier}" if args.max_tier < 10 else ''))
+        header = f"{'port':<8} {'time':>10} {'puzzles/s':>10} {'solved':>7} {'work':>10} {'agree':>7}"
+        if args.latency:
+            header += f" {'startup':>9} {'p50':>9} {'p95':>9} {'max':>9}"
+        print(header)
+
+        reference = None
+        for port, command in ports:
+            best = None
+            records = {}
+            error = None
+            for _ in range(max(1, args.repeat)):
+                elapsed, records, error = run_port(command, corpus, args, timeout=args.timeout)
+                if error:
+                    break
+                best = elapsed if best is None else min(best, elapsed)
+            if error:
+                print(f"{port:<8} {error}")
+                continue
+
+            solved = sum(1 for status, _, _ in records.values() if status == 'solved')
+            work = sum(score or 0 for status, _, score in records.values() if status == 'solved')
+            mismatches = []
+            if reference is None:
+                reference = records
+                agree = 'ref'
+            else:
+                mismatches = compare_records(reference, records)
+                agree = f"{len(reference) - len(set(m[0] for m in mismatches))}/{len(reference)}"
+            rate = len(records) / best if best > 0 else 0
+
+            line = (f"{port:<8} {best:>9.3f}s {rate:>10.1f} {solved:>7} {work:>10} {agree:>7}")
+            if args.latency:
+                times = measure_latency(command, corpus, args, num_records)
+                if times:
+                    line += (f" {format_ms(startup.get(port)):>9} {format_ms(statistics.median(times)):>9}"
+                             f" {format_ms(percentile(times, 0.95)):>9} {format_ms(max(times)):>9}")
+            print(line)
+
+            if mismatches:
+                any_mismatch = True
+                for name, field, want, have in mismatches[:args.show]:
+                    print(f"    {name}: {field} {want!r} != {have!r}")
+                if len(mismatches) > args.show:
+                    print(f"    ... {len(mismatches) - args.show} more")
+
+    return 1 if any_mismatch else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,38 @@
+#include "arena.h"
+#include <algorithm>
+
+namespace {
+
+// Records reserved up front; most searches never go deeper
+constexpr int INITIAL_DEPTH = 16;
+
+}  // namespace
+
+SearchArena::SearchArena(const Board& board)
+    : recordWords(board.snapshotWords()), maxDepth(board.getUnknownCount() + 1) {
+    block.resize(std::min(INITIAL_DEPTH, maxDepth) * recordWords);
+    scratch.resize(recordWords);
+}
+
+void SearchArena::push(const Board& board) {
+    size_t offset = depth * recordWords;
+    if (offset + recordWords > block.size()) {
+        size_t records = std::max<size_t>(depth + 1, std::min<size_t>(maxDepth, 2 * block.size() / recordWords));
+        block.resize(records * recordWords);
+    }
+    board.saveSnapshot(block.data() + offset);
+    depth++;
+}
+
+void SearchArena::pop(Board& board) {
+    depth--;
+    board.restoreSnapshot(block.data() + depth * recordWords);
+}
+
+void SearchArena::saveScratch(const Board& board) {
+    board.saveSnapshot(scratch.data());
+}
+
+void SearchArena::restoreScratch(Board& board) const {
+    board.restoreSnapshot(scratch.data());
+}
@@ -0,0 +1,43 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include "board.h"
+#include <cstdint>
+#include <vector>
+
+// SearchArena is the BF search stack: board snapshots stored back to back
+// as fixed-size records in one contiguous block. Push and pop move a
+// depth counter; the block only grows (by doubling) when the search goes
+// deeper than it has before, and never beyond maxDepth records.
+class SearchArena {
+public:
+    // SearchArena sizes records for board. BF keeps at most one record per
+    // unknown cell plus the root on its stack, so that is the maximum depth.
+    explicit SearchArena(const Board& board);
+
+    bool empty() const { return depth == 0; }
+    int size() const { return depth; }
+
+    // push appends a snapshot of board
+    void push(const Board& board);
+
+    // pop restores board from the top record and removes it
+    void pop(Board& board);
+
+    // saveScratch and restoreScratch keep one snapshot outside the stack, for
+    // returning to a node between placing each of its branch values
+    void saveScratch(const Board& board);
+    void restoreScratch(Board& board) const;
+
+    // Peak memory of the block in bytes if the search reaches maxDepth
+    size_t maxBytes() const { return (size_t)maxDepth * recordWords * sizeof(uint32_t); }
+
+private:
+    size_t recordWords;
+    int maxDepth;
+    int depth = 0;
+    std::vector<uint32_t> block;
+    std::vector<uint32_t> scratch;
+};
+
+#endif // ARENA_H
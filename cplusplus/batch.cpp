@@ -0,0 +1,432 @@
+#include "batch.h"
+#include "board.h"
+#include <algorithm>
+#include <cstdint>
+
+// Lanes holds one bit per puzzle in a batch
+using Lanes = uint64_t;
+
+// Counter3 is a bit-sliced 3-bit counter holding one count (0-7) per lane
+struct Counter3 {
+    Lanes b0 = 0;
+    Lanes b1 = 0;
+    Lanes b2 = 0;
+
+    // add increments the count of every lane set in x
+    void add(Lanes x) {
+        Lanes carry1 = b0 & x;
+        b0 ^= x;
+        Lanes carry2 = b1 & carry1;
+        b1 ^= carry1;
+        b2 |= carry2;
+    }
+};
+
+static Lanes equalLanes(const Counter3& a, const Counter3& b) {
+    return ~((a.b0 ^ b.b0) | (a.b1 ^ b.b1) | (a.b2 ^ b.b2));
+}
+
+static Lanes greaterLanes(const Counter3& a, const Counter3& b) {
+    Lanes eq2 = ~(a.b2 ^ b.b2);
+    Lanes eq1 = ~(a.b1 ^ b.b1);
+    return (a.b2 & ~b.b2) | (eq2 & ((a.b1 & ~b.b1) | (eq1 & a.b0 & ~b.b0)));
+}
+
+// forEachLane calls fn(lane) for every lane set in lanes
+template <typename Fn>
+static void forEachLane(Lanes lanes, Fn fn) {
+    while (lanes) {
+        fn(__builtin_ctzll(lanes));
+        lanes &= lanes - 1;
+    }
+}
+
+// BatchRule is one of the leading entries of getRules(), which the batch
+// replays in the same order and with the same scores and tiers.
+// border_two_v_shape and loop_avoidance_2 come next in getRules() but are
+// left out: the scalar loop only reaches them when none of these four
+// fires, and such lanes leave the batch for solveFn anyway.
+struct BatchRule {
+    enum Kind { CLUE_FINISH_B, CLUE_FINISH_A, NO_LOOPS, EDGE_CLUE } kind;
+    int score;
+    int tier;
+};
+
+static const BatchRule BATCH_RULES[] = {
+    {BatchRule::CLUE_FINISH_B, 1, 1},
+    {BatchRule::CLUE_FINISH_A, 2, 1},
+    {BatchRule::NO_LOOPS, 2, 1},
+    {BatchRule::EDGE_CLUE, 2, 2},
+};
+
+// LaneBatch holds up to BATCH_LANES boards of one size in bit-sliced form:
+// bit l of every word belongs to the puzzle in lane l.
+class LaneBatch {
+public:
+    LaneBatch(int width, int height);
+
+    // load puts a puzzle's clues into a lane and returns false if the givens
+    // are malformed or do not match the board size
+    bool load(int lane, const std::string& givens);
+
+    // run replays the rule loop restricted to the BATCH_RULES up to maxTier
+    // for the given lanes, adding each lane's rule scores to scores and
+    // raising tiers to the highest tier fired. Lanes that end solved with
+    // every clue met are returned; the others stopped because the scalar
+    // solver would need another rule or would give up.
+    Lanes run(Lanes active, bool stopWhenInvalid, int maxTier, int* scores, int* tiers);
+
+    std::string solution(int lane) const;
+
+private:
+    int width;
+    int height;
+    int numCells;
+    int numVertices;
+
+    std::vector<Lanes> slash;       // per cell: lanes holding '/'
+    std::vector<Lanes> backslash;   // per cell: lanes holding '\'
+    std::vector<Lanes> touched;     // per vertex: lanes where a placed diagonal ends here
+    std::vector<Lanes> hasClue;     // per vertex
+    std::vector<Counter3> clue;     // per vertex
+    std::shared_ptr<const BoardGeometry> geometry;
+    std::vector<int> cluedOrder;    // vertices clued in any lane, in board order
+
+    // Vertex union-find for each lane, lane-major
+    std::vector<uint16_t> parent;
+
+    int find(int lane, int v);
+    void diagonalEnds(int cell, int value, int& v1, int& v2) const;
+    Lanes loopLanes(Lanes lanes, int v1, int v2);
+    Counter3 countTouches(int v) const;
+    Lanes place(Lanes lanes, int cell, int value);
+    Lanes sweepClueFinish(bool finishA, Lanes mask);
+    Lanes sweepNoLoops(Lanes mask);
+    Lanes sweepEdgeClue(Lanes mask);
+    Lanes solvedLanes() const;
+    Lanes overfullLanes() const;
+    Lanes exactLanes() const;
+};
+
+LaneBatch::LaneBatch(int w, int h)
+    : width(w), height(h), numCells(w * h), numVertices((w + 1) * (h + 1)),
+      slash(numCells, 0), backslash(numCells, 0), touched(numVertices, 0),
+      hasClue(numVertices, 0), clue(numVertices), geometry(BoardGeometry::get(w, h)),
+      parent((size_t)BATCH_LANES * numVertices) {
+    for (int lane = 0; lane < BATCH_LANES; lane++) {
+        for (int v = 0; v < numVertices; v++) {
+            parent[(size_t)lane * numVertices + v] = (uint16_t)v;
+        }
+    }
+}
+
+bool LaneBatch::load(int lane, const std::string& givens) {
+    Lanes bit = Lanes(1) << lane;
+    auto status = Board::decodeGivens(givens, numVertices, [&](int v, int value) {
+        hasClue[v] |= bit;
+        clue[v].b0 |= (value & 1) ? bit : 0;
+        clue[v].b1 |= (value & 2) ? bit : 0;
+        clue[v].b2 |= (value & 4) ? bit : 0;
+    });
+    if (status == GivensStatus::OK) {
+        return true;
+    }
+
+    // Clear whatever was decoded before the error
+    for (int v = 0; v < numVertices; v++) {
+        hasClue[v] &= ~bit;
+        clue[v].b0 &= ~bit;
+        clue[v].b1 &= ~bit;
+        clue[v].b2 &= ~bit;
+    }
+    return false;
+}
+
+int LaneBatch::find(int lane, int v) {
+    uint16_t* p = &parent[(size_t)lane * numVertices];
+    while (p[v] != v) {
+        p[v] = p[p[v]];
+        v = p[v];
+    }
+    return v;
+}
+
+Counter3 LaneBatch::countTouches(int v) const {
+    const VertexNeighbour* around = geometry->neighboursBegin(v);
+    int numAround = (int)(geometry->neighboursEnd(v) - around);
+    Counter3 count;
+    for (int i = 0; i < numAround; i++) {
+        int c = around[i].cell;
+        count.add(around[i].slashTouches ? slash[c] : backslash[c]);
+    }
+    return count;
+}
+
+// diagonalEnds returns the vertices joined by value in cell
+void LaneBatch::diagonalEnds(int cell, int value, int& v1, int& v2) const {
+    const auto& corners = geometry->cellCorners[cell];
+    v1 = (value == SLASH) ? corners[2] : corners[0];
+    v2 = (value == SLASH) ? corners[1] : corners[3];
+}
+
+// loopLanes returns the lanes in which v1 and v2 are already connected
+Lanes LaneBatch::loopLanes(Lanes lanes, int v1, int v2) {
+    // A loop needs both ends on diagonals placed earlier
+    Lanes loops = 0;
+    forEachLane(lanes & touched[v1] & touched[v2], [&](int lane) {
+        if (find(lane, v1) == find(lane, v2)) {
+            loops |= Lanes(1) << lane;
+        }
+    });
+    return loops;
+}
+
+// place puts value in cell for the given lanes, skipping lanes where it would
+// close a loop, and returns the lanes where it was placed
+Lanes LaneBatch::place(Lanes lanes, int cell, int value) {
+    int v1, v2;
+    diagonalEnds(cell, value, v1, v2);
+    lanes &= ~loopLanes(lanes, v1, v2);
+    forEachLane(lanes, [&](int lane) {
+        parent[(size_t)lane * numVertices + find(lane, v1)] = (uint16_t)find(lane, v2);
+    });
+
+    (value == SLASH ? slash : backslash)[cell] |= lanes;
+    touched[v1] |= lanes;
+    touched[v2] |= lanes;
+    return lanes;
+}
+
+// sweepClueFinish applies clue_finish_a (finishA) or clue_finish_b to the
+// lanes in mask, visiting clued vertices in board order like the scalar rule,
+// and returns the lanes where it placed anything
+Lanes LaneBatch::sweepClueFinish(bool finishA, Lanes mask) {
+    Lanes progress = 0;
+    for (int v : cluedOrder) {
+        Lanes m = mask & hasClue[v];
+        if (!m) {
+            continue;
+        }
+        const VertexNeighbour* around = geometry->neighboursBegin(v);
+        int numAround = (int)(geometry->neighboursEnd(v) - around);
+        Lanes unknown[4];
+        Lanes anyUnknown = 0;
+        Counter3 target;
+        for (int i = 0; i < numAround; i++) {
+            int c = around[i].cell;
+            Lanes touch = around[i].slashTouches ? slash[c] : backslash[c];
+            unknown[i] = ~(slash[c] | backslash[c]);
+            anyUnknown |= unknown[i];
+            // finish_a: touches plus unknowns equal the clue; finish_b: touches alone do
+            target.add(finishA ? (touch | unknown[i]) : touch);
+        }
+        Lanes fire = m & anyUnknown & equalLanes(target, clue[v]);
+        if (!fire) {
+            continue;
+        }
+        for (int i = 0; i < numAround; i++) {
+            Lanes lanes = fire & unknown[i];
+            if (lanes) {
+                int value = (around[i].slashTouches == finishA) ? SLASH : BACKSLASH;
+                progress |= place(lanes, around[i].cell, value);
+            }
+        }
+    }
+    return progress;
+}
+
+// sweepNoLoops applies no_loops to the lanes in mask, visiting cells in board
+// order, and returns the lanes where it placed anything
+Lanes LaneBatch::sweepNoLoops(Lanes mask) {
+    Lanes progress = 0;
+    for (int c = 0; c < numCells; c++) {
+        Lanes unknown = mask & ~(slash[c] | backslash[c]);
+        if (!unknown) {
+            continue;
+        }
+        int s1, s2, b1, b2;
+        diagonalEnds(c, SLASH, s1, s2);
+        diagonalEnds(c, BACKSLASH, b1, b2);
+        Lanes slashLoops = loopLanes(unknown, s1, s2);
+        Lanes backslashLoops = loopLanes(unknown, b1, b2);
+        progress |= place(slashLoops & ~backslashLoops, c, BACKSLASH);
+        progress |= place(backslashLoops & ~slashLoops, c, SLASH);
+    }
+    return progress;
+}
+
+// sweepEdgeClue applies edge_clue_constraints to the lanes in mask: a clue
+// equal to the number of cells around its vertex needs all of them to touch
+Lanes LaneBatch::sweepEdgeClue(Lanes mask) {
+    Lanes progress = 0;
+    for (int v : cluedOrder) {
+        Lanes m = mask & hasClue[v];
+        if (!m) {
+            continue;
+        }
+        const VertexNeighbour* around = geometry->neighboursBegin(v);
+        int numAround = (int)(geometry->neighboursEnd(v) - around);
+        Counter3 maxPossible;
+        for (int i = 0; i < numAround; i++) {
+            maxPossible.add(~Lanes(0));
+        }
+        Lanes fire = m & equalLanes(maxPossible, clue[v]);
+        if (!fire) {
+            continue;
+        }
+        for (int i = 0; i < numAround; i++) {
+            int c = around[i].cell;
+            Lanes lanes = fire & ~(slash[c] | backslash[c]);
+            if (lanes) {
+                progress |= place(lanes, c, around[i].slashTouches ? SLASH : BACKSLASH);
+            }
+        }
+    }
+    return progress;
+}
+
+Lanes LaneBatch::solvedLanes() const {
+    Lanes solved = ~Lanes(0);
+    for (int c = 0; c < numCells; c++) {
+        solved &= slash[c] | backslash[c];
+    }
+    return solved;
+}
+
+Lanes LaneBatch::overfullLanes() const {
+    Lanes overfull = 0;
+    for (int v : cluedOrder) {
+        overfull |= hasClue[v] & greaterLanes(countTouches(v), clue[v]);
+    }
+    return overfull;
+}
+
+Lanes LaneBatch::exactLanes() const {
+    Lanes exact = ~Lanes(0);
+    for (int v : cluedOrder) {
+        exact &= ~hasClue[v] | equalLanes(countTouches(v), clue[v]);
+    }
+    return exact;
+}
+
+Lanes LaneBatch::run(Lanes active, bool stopWhenInvalid, int maxTier, int* scores, int* tiers) {
+    cluedOrder.clear();
+    for (int v = 0; v < numVertices; v++) {
+        if (hasClue[v]) {
+            cluedOrder.push_back(v);
+        }
+    }
+
+    Lanes finished = 0;
+    while (active) {
+        Lanes solved = solvedLanes() & active;
+        Lanes stop = solved;
+        if (stopWhenInvalid) {
+            stop |= overfullLanes() & active;
+        }
+        finished |= solved & exactLanes();
+        active &= ~stop;
+        if (!active) {
+            break;
+        }
+
+        // The scalar loop fires the first rule that makes progress, so each
+        // rule only runs on the lanes where the ones before it did nothing
+        Lanes rest = active;
+        Lanes fired = 0;
+        for (const auto& rule : BATCH_RULES) {
+            if (!rest) {
+                break;
+            }
+            if (rule.tier > maxTier) {
+                continue;
+            }
+            Lanes progress = 0;
+            switch (rule.kind) {
+                case BatchRule::CLUE_FINISH_B:
+                    progress = sweepClueFinish(false, rest);
+                    break;
+                case BatchRule::CLUE_FINISH_A:
+                    progress = sweepClueFinish(true, rest);
+                    break;
+                case BatchRule::NO_LOOPS:
+                    progress = sweepNoLoops(rest);
+                    break;
+                case BatchRule::EDGE_CLUE:
+                    progress = sweepEdgeClue(rest);
+                    break;
+            }
+            forEachLane(progress, [&](int lane) {
+                scores[lane] += rule.score;
+                tiers[lane] = std::max(tiers[lane], rule.tier);
+            });
+            fired |= progress;
+            rest &= ~progress;
+        }
+
+        // Lanes where no rule fired would move on to rules the batch lacks
+        active &= fired;
+    }
+    return finished;
+}
+
+std::string LaneBatch::solution(int lane) const {
+    Lanes bit = Lanes(1) << lane;
+    std::string result(numCells, '.');
+    for (int c = 0; c < numCells; c++) {
+        if (slash[c] & bit) {
+            result[c] = '/';
+        } else if (backslash[c] & bit) {
+            result[c] = '\\';
+        }
+    }
+    return result;
+}
+
+std::vector<SolveResult> SolveBatch(const std::vector<std::string>& givens, int width, int height,
+                                    SolveFunc solveFn, const SolveOptions& options) {
+    std::vector<SolveResult> results(givens.size());
+    std::vector<size_t> fallback;
+
+    // BF pops its initial state once (2 points) and gives up on invalid boards
+    bool branching = (solveFn == SolveBF);
+    bool batchable = width > 0 && height > 0 && width * height <= BATCH_MAX_CELLS &&
+                     options.maxTier >= 1 && !options.largeBoard && options.propagationThreads <= 1;
+
+    for (size_t first = 0; first < givens.size(); first += BATCH_LANES) {
+        int count = (int)std::min<size_t>(BATCH_LANES, givens.size() - first);
+        if (!batchable) {
+            for (int lane = 0; lane < count; lane++) {
+                fallback.push_back(first + lane);
+            }
+            continue;
+        }
+
+        LaneBatch batch(width, height);
+        Lanes loaded = 0;
+        for (int lane = 0; lane < count; lane++) {
+            if (batch.load(lane, givens[first + lane])) {
+                loaded |= Lanes(1) << lane;
+            } else {
+                fallback.push_back(first + lane);
+            }
+        }
+
+        int scores[BATCH_LANES] = {};
+        int tiers[BATCH_LANES] = {};
+        Lanes finished = batch.run(loaded, branching, options.maxTier, scores, tiers);
+        forEachLane(loaded, [&](int lane) {
+            if (finished & (Lanes(1) << lane)) {
+                int workScore = scores[lane] + (branching ? 2 : 0);
+                results[first + lane] = {"solved", batch.solution(lane), workScore, tiers[lane]};
+            } else {
+                fallback.push_back(first + lane);
+            }
+        });
+    }
+
+    for (size_t idx : fallback) {
+        results[idx] = solveFn(givens[idx], width, height, options);
+    }
+    return results;
+}
@@ -0,0 +1,27 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "solver.h"
+#include <string>
+#include <vector>
+
+// Number of puzzles propagated together, one per bit of a 64-bit word
+constexpr int BATCH_LANES = 64;
+
+// Boards with more cells than this are always solved one at a time
+constexpr int BATCH_MAX_CELLS = 1024;
+
+// SolveFunc is the signature shared by SolveBF and SolvePR
+using SolveFunc = SolveResult (*)(const std::string&, int, int, const SolveOptions&);
+
+// SolveBatch solves puzzles that all have the same width and height. Up to
+// BATCH_LANES of them at a time are packed into bit-sliced words and run
+// through clue_finish_b, clue_finish_a, no_loops and edge_clue_constraints
+// in lockstep, replaying the rule loop of solveFn lane by lane. Puzzles
+// those rules cannot finish are handed to solveFn, so every result
+// (including the work score) is the one solveFn would return. Results are
+// in input order.
+std::vector<SolveResult> SolveBatch(const std::vector<std::string>& givens, int width, int height,
+                                    SolveFunc solveFn, const SolveOptions& options);
+
+#endif // BATCH_H
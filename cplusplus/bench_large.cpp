@@ -0,0 +1,105 @@
+// bench_large: generate very large random Slants puzzles and time the
+// solvers on them in large-board mode.
+//
+// Each instance is a random loop-free fill of an NxN grid whose vertex
+// clues are all given, then thinned by removing each clue with the given
+// probability. Instances are reproducible from the seed.
+
+#include "generate.h"
+#include "solver.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// encodeGivens computes the vertex clues of a solution, drops each with
+// probability dropRate, and RLE-encodes the result.
+std::string encodeGivens(int width, int height, const std::vector<int>& solution,
+                         double dropRate, std::mt19937& rng) {
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::vector<int> clues = SolutionClues(width, height, solution);
+    for (int& clue : clues) {
+        if (uniform(rng) < dropRate) {
+            clue = -1;
+        }
+    }
+    return EncodeGivens(clues);
+}
+
+void printUsage(const char* progname) {
+    std::cerr << "Usage: " << progname << " [options] [size ...]\n";
+    std::cerr << "Options:\n";
+    std::cerr << "  -s <solver>   Solver to use: PR or BF (default BF)\n";
+    std::cerr << "  -drop <rate>  Fraction of clues removed (default 0.0)\n";
+    std::cerr << "  -r <seed>     Random seed (default 1)\n";
+    std::cerr << "  -normal       Disable large-board mode (for comparison)\n";
+    std::cerr << "  -pt <threads> Parallel propagation threads (default 1)\n";
+    std::cerr << "Sizes default to 100 300 1000 (square boards).\n";
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    std::string solver = "BF";
+    double dropRate = 0.0;
+    unsigned seed = 1;
+    bool largeBoard = true;
+    int threads = 1;
+    std::vector<int> sizes;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-s" && i + 1 < argc) {
+            solver = argv[++i];
+        } else if (arg == "-drop" && i + 1 < argc) {
+            dropRate = std::atof(argv[++i]);
+        } else if (arg == "-r" && i + 1 < argc) {
+            seed = (unsigned)std::stoul(argv[++i]);
+        } else if (arg == "-normal") {
+            largeBoard = false;
+        } else if (arg == "-pt" && i + 1 < argc) {
+            threads = std::stoi(argv[++i]);
+        } else if (arg[0] != '-') {
+            sizes.push_back(std::stoi(arg));
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (sizes.empty()) {
+        sizes = {100, 300, 1000};
+    }
+
+    auto solveFn = (solver == "PR") ? SolvePR : SolveBF;
+    SolveOptions options;
+    options.largeBoard = largeBoard;
+    options.propagationThreads = threads;
+
+    std::cout << "size\tgen_s\tsolve_s\tstatus\tunsolved\twork_score\n";
+    for (int n : sizes) {
+        std::mt19937 rng(seed);
+        auto genStart = std::chrono::high_resolution_clock::now();
+        auto solution = GenerateSolution(n, n, rng);
+        std::string givens = encodeGivens(n, n, solution, dropRate, rng);
+        auto genEnd = std::chrono::high_resolution_clock::now();
+
+        SolveResult result = solveFn(givens, n, n, options);
+        auto solveEnd = std::chrono::high_resolution_clock::now();
+
+        int unsolved = 0;
+        for (char c : result.solutionString) {
+            if (c == '.') unsolved++;
+        }
+
+        std::cout << n << "x" << n << "\t"
+                  << std::chrono::duration<double>(genEnd - genStart).count() << "\t"
+                  << std::chrono::duration<double>(solveEnd - genEnd).count() << "\t"
+                  << result.status << "\t" << unsolved << "\t" << result.workScore << "\n";
+    }
+    return 0;
+}
@@ -1,8 +1,9 @@
 #include "board.h"
-#include <stdexcept>
+#include <algorithm>
+#include <cstring>
 
-Board::Board(int w, int h, const std::string& givensString)
-    : width(w), height(h) {
+Board::Board(int w, int h)
+    : width(w), height(h), geometry(BoardGeometry::get(w, h)) {
 
     // Initialize cells
     cells.reserve(width * height);
@@ -12,48 +13,61 @@ Board::Board(int w, int h, const std::string& givensString)
         }
     }
 
-    // Decode givens and initialize vertices
-    auto decodedClues = decodeGivens(givensString);
-    int expectedVertices = (width + 1) * (height + 1);
+    // Initialize vertices without clues
+    vertices.reserve((width + 1) * (height + 1));
+    for (int vy = 0; vy <= height; vy++) {
+        for (int vx = 0; vx <= width; vx++) {
+            vertices.push_back(std::make_unique<Vertex>(vx, vy, -1));
+        }
+    }
+}
 
-    if ((int)decodedClues.size() != expectedVertices) {
-        throw std::runtime_error("Givens decode mismatch");
+std::unique_ptr<Board> Board::fromGivens(int w, int h, const std::string& givensString,
+                                         GivensStatus& status) {
+    if (w <= 0 || h <= 0) {
+        status = GivensStatus::BAD_SIZE;
+        return nullptr;
     }
 
-    vertices.reserve(expectedVertices);
-    for (int i = 0; i < expectedVertices; i++) {
-        int vx = i % (width + 1);
-        int vy = i / (width + 1);
-        vertices.push_back(std::make_unique<Vertex>(vx, vy, decodedClues[i]));
+    std::unique_ptr<Board> board(new Board(w, h));
+    status = decodeGivens(givensString, (int)board->vertices.size(), [&](int v, int clue) {
+        Vertex* vertex = board->vertices[v].get();
+        vertex->clue = clue;
+        vertex->hasClue = true;
+    });
+    if (status != GivensStatus::OK) {
+        return nullptr;
     }
 
+    board->init();
+    return board;
+}
+
+void Board::init() {
+    initPaddedGrids();
     initUnionFind();
     initEquivalence();
     initVBitmap();
     initExitsBorder();
-}
-
-std::vector<int> Board::decodeGivens(const std::string& givensString) {
-    std::vector<int> result;
-    for (char c : givensString) {
-        if (c >= '0' && c <= '4') {
-            result.push_back(c - '0');
-        } else if (c >= 'a' && c <= 'z') {
-            int runLength = c - 'a' + 1;
-            for (int i = 0; i < runLength; i++) {
-                result.push_back(-1);  // -1 means no clue
-            }
-        }
-    }
-    return result;
+    initCluedVertices();
+    initUnknownSet();
 }
 
 void Board::initUnionFind() {
-    int numVertices = (width + 1) * (height + 1);
-    parent.resize(numVertices);
-    rank.resize(numVertices, 0);
-    for (int i = 0; i < numVertices; i++) {
-        parent[i] = i;
+    // With an odd stride an id's parity is the vertex parity. When width + 1
+    // is even, each row gets one padding id that is never joined.
+    vertexStride = (width + 1) | 1;
+    int numIds = vertexStride * (height + 1);
+    for (int p = 0; p < 2; p++) {
+        VertexForest& forest = forests[p];
+        int size = (numIds + 1 - p) / 2;
+        forest.parent.resize(size);
+        forest.rank.resize(size, 0);
+        forest.exits.resize(size, 4);
+        forest.border.resize(size, 0);
+        for (int i = 0; i < size; i++) {
+            forest.parent[i] = i;
+        }
     }
 }
 
@@ -75,57 +89,125 @@ void Board::initVBitmap() {
 void Board::initExitsBorder() {
     int W = width + 1;
     int H = height + 1;
-    int numVertices = W * H;
-
-    exits.resize(numVertices);
-    border.resize(numVertices, false);
 
     for (int vy = 0; vy < H; vy++) {
         for (int vx = 0; vx < W; vx++) {
-            int idx = vy * W + vx;
-            // Border if on edge
-            if (vy == 0 || vy == H - 1 || vx == 0 || vx == W - 1) {
-                border[idx] = true;
-            }
+            int id = vertexId(vx, vy);
+            VertexForest& forest = forests[id & 1];
             // Exits = clue value, or 4 if no clue
-            Vertex* vertex = getVertex(vx, vy);
-            if (vertex->hasClue) {
-                exits[idx] = vertex->clue;
-            } else {
-                exits[idx] = 4;
-            }
+            Vertex* vertex = vertexAt(vx, vy);
+            forest.exits[id >> 1] = vertex->hasClue ? vertex->clue : 4;
+            forest.border[id >> 1] = geometry->borderMask[vy * W + vx];
         }
     }
 }
 
-int Board::find(int x) {
-    if (parent[x] != x) {
-        parent[x] = find(parent[x]);
+void Board::initPaddedGrids() {
+    sentinelCell.value = OUTSIDE;
+
+    cellGrid.assign((width + 2) * (height + 2), &sentinelCell);
+    for (size_t i = 0; i < cells.size(); i++) {
+        cellGrid[geometry->cellSlot[i]] = cells[i].get();
+    }
+
+    vertexGrid.assign((width + 3) * (height + 3), &sentinelVertex);
+    for (size_t i = 0; i < vertices.size(); i++) {
+        vertexGrid[geometry->vertexSlot[i]] = vertices[i].get();
     }
-    return parent[x];
 }
 
-bool Board::unite(int x, int y) {
-    int rx = find(x);
-    int ry = find(y);
+void Board::initCluedVertices() {
+    for (auto& v : vertices) {
+        if (v->hasClue) {
+            cluedVertices.push_back(v.get());
+            cluedByValue[v->clue].push_back(v.get());
+        }
+    }
+}
+
+void Board::initUnknownSet() {
+    int numCells = width * height;
+    unknownDense.resize(numCells);
+    unknownPos.resize(numCells);
+    for (int i = 0; i < numCells; i++) {
+        unknownDense[i] = cells[i].get();
+        unknownPos[i] = i;
+    }
+    numUnknown = numCells;
+}
+
+void Board::unknownRemove(int idx) {
+    // Swap the cell with the last unknown cell and shrink the set
+    int pos = unknownPos[idx];
+    Cell* last = unknownDense[numUnknown - 1];
+    int lastIdx = cellIndex(last);
+    unknownDense[pos] = last;
+    unknownPos[lastIdx] = pos;
+    unknownDense[numUnknown - 1] = cells[idx].get();
+    unknownPos[idx] = numUnknown - 1;
+    numUnknown--;
+}
+
+void Board::unknownInsert(int idx) {
+    // Swap the cell with the first known cell and grow the set
+    int pos = unknownPos[idx];
+    Cell* first = unknownDense[numUnknown];
+    int firstIdx = cellIndex(first);
+    unknownDense[pos] = first;
+    unknownPos[firstIdx] = pos;
+    unknownDense[numUnknown] = cells[idx].get();
+    unknownPos[idx] = numUnknown;
+    numUnknown++;
+}
+
+int Board::find(int id) {
+    std::vector<int>& parent = forests[id & 1].parent;
+    // Iterative so long chains on very large boards cannot overflow the stack
+    int x = id >> 1;
+    int root = x;
+    while (parent[root] != root) {
+        root = parent[root];
+    }
+    while (parent[x] != root) {
+        int next = parent[x];
+        parent[x] = root;
+        x = next;
+    }
+    return (root << 1) | (id & 1);
+}
+
+int Board::findReadOnly(int id) const {
+    const std::vector<int>& parent = forests[id & 1].parent;
+    int x = id >> 1;
+    while (parent[x] != x) {
+        x = parent[x];
+    }
+    return (x << 1) | (id & 1);
+}
+
+// unite joins the groups of two vertices of the same parity
+bool Board::unite(int id1, int id2) {
+    int rx = find(id1) >> 1;
+    int ry = find(id2) >> 1;
     if (rx == ry) {
         return false;  // Already connected - would form a loop
     }
+    VertexForest& forest = forests[id1 & 1];
 
     // Merge exits and border info
-    int mergedExits = exits[rx] + exits[ry] - 2;
-    bool mergedBorder = border[rx] || border[ry];
+    int mergedExits = forest.exits[rx] + forest.exits[ry] - 2;
+    uint8_t mergedBorder = forest.border[rx] | forest.border[ry];
 
-    if (rank[rx] < rank[ry]) {
+    if (forest.rank[rx] < forest.rank[ry]) {
         std::swap(rx, ry);
     }
-    parent[ry] = rx;
-    if (rank[rx] == rank[ry]) {
-        rank[rx]++;
+    forest.parent[ry] = rx;
+    if (forest.rank[rx] == forest.rank[ry]) {
+        forest.rank[rx]++;
     }
 
-    exits[rx] = mergedExits;
-    border[rx] = mergedBorder;
+    forest.exits[rx] = mergedExits;
+    forest.border[rx] = mergedBorder;
 
     return true;
 }
@@ -139,10 +221,16 @@ int Board::cellIndex(Cell* cell) {
 }
 
 int Board::equivFind(int x) {
-    if (equivParent[x] != x) {
-        equivParent[x] = equivFind(equivParent[x]);
+    int root = x;
+    while (equivParent[root] != root) {
+        root = equivParent[root];
     }
-    return equivParent[x];
+    while (equivParent[x] != root) {
+        int next = equivParent[x];
+        equivParent[x] = root;
+        x = next;
+    }
+    return root;
 }
 
 Cell* Board::getCell(int x, int y) {
@@ -159,93 +247,85 @@ Vertex* Board::getVertex(int vx, int vy) {
     return nullptr;
 }
 
-std::vector<Vertex*> Board::getCluedVertices() {
-    std::vector<Vertex*> result;
-    for (auto& v : vertices) {
-        if (v->hasClue) {
-            result.push_back(v.get());
-        }
-    }
-    return result;
-}
-
 std::vector<Cell*> Board::getUnknownCells() {
+    // Rules visit unknown cells in board order. While most cells are still
+    // unknown a straight scan is cheapest; late in the solve only the live
+    // part of the sparse set is copied and sorted.
     std::vector<Cell*> result;
-    for (auto& c : cells) {
-        if (c->value == UNKNOWN) {
-            result.push_back(c.get());
+    result.reserve(numUnknown);
+    if (numUnknown * 8 >= (int)cells.size()) {
+        for (auto& c : cells) {
+            if (c->value == UNKNOWN) {
+                result.push_back(c.get());
+            }
         }
+    } else {
+        result.assign(unknownDense.begin(), unknownDense.begin() + numUnknown);
+        std::sort(result.begin(), result.end(), [this](Cell* a, Cell* b) {
+            return cellIndex(a) < cellIndex(b);
+        });
     }
     return result;
 }
 
-std::vector<AdjacentCellInfo> Board::getAdjacentCellsForVertex(Vertex* vertex) {
-    int vx = vertex->vx;
-    int vy = vertex->vy;
-    std::vector<AdjacentCellInfo> adjacent;
+AdjacentList Board::getAdjacentCellsForVertex(Vertex* vertex) {
+    int v = vertexIndex(vertex->vx, vertex->vy);
+    AdjacentList adjacent;
 
-    // Top-left cell (vertex is its bottom-right corner)
-    if (Cell* cell = getCell(vx - 1, vy - 1)) {
-        adjacent.push_back({cell, false, true});
-    }
-    // Top-right cell (vertex is its bottom-left corner)
-    if (Cell* cell = getCell(vx, vy - 1)) {
-        adjacent.push_back({cell, true, false});
-    }
-    // Bottom-left cell (vertex is its top-right corner)
-    if (Cell* cell = getCell(vx - 1, vy)) {
-        adjacent.push_back({cell, true, false});
-    }
-    // Bottom-right cell (vertex is its top-left corner)
-    if (Cell* cell = getCell(vx, vy)) {
-        adjacent.push_back({cell, false, true});
+    // Top-left, top-right, bottom-left, bottom-right, as far as on the board
+    for (auto* n = geometry->neighboursBegin(v); n != geometry->neighboursEnd(v); n++) {
+        adjacent.push_back({cells[n->cell].get(), n->slashTouches, !n->slashTouches});
     }
 
     return adjacent;
 }
 
 std::pair<int, int> Board::countTouches(Vertex* vertex) {
-    int current = 0;
-    int unknown = 0;
-
-    for (auto& adj : getAdjacentCellsForVertex(vertex)) {
-        if (adj.cell->value == UNKNOWN) {
-            unknown++;
-        } else if (adj.cell->value == SLASH && adj.slashTouches) {
-            current++;
-        } else if (adj.cell->value == BACKSLASH && adj.backslashTouches) {
-            current++;
-        }
-    }
+    int vx = vertex->vx;
+    int vy = vertex->vy;
+
+    // Sentinel cells are OUTSIDE, so they count as neither unknown nor touching
+    int tl = cellAt(vx - 1, vy - 1)->value;
+    int tr = cellAt(vx, vy - 1)->value;
+    int bl = cellAt(vx - 1, vy)->value;
+    int br = cellAt(vx, vy)->value;
+
+    int current = (tl == BACKSLASH) + (tr == SLASH) + (bl == SLASH) + (br == BACKSLASH);
+    int unknown = (tl == UNKNOWN) + (tr == UNKNOWN) + (bl == UNKNOWN) + (br == UNKNOWN);
 
     return {current, unknown};
 }
 
 void Board::getCellCorners(Cell* cell, Vertex** tl, Vertex** tr, Vertex** bl, Vertex** br) {
-    int x = cell->x;
-    int y = cell->y;
-    *tl = getVertex(x, y);
-    *tr = getVertex(x + 1, y);
-    *bl = getVertex(x, y + 1);
-    *br = getVertex(x + 1, y + 1);
+    const auto& corners = geometry->cellCorners[cellIndex(cell)];
+    *tl = vertices[corners[0]].get();
+    *tr = vertices[corners[1]].get();
+    *bl = vertices[corners[2]].get();
+    *br = vertices[corners[3]].get();
 }
 
 bool Board::wouldFormLoop(Cell* cell, int value) {
-    int x = cell->x;
-    int y = cell->y;
-    int v1, v2;
-
-    if (value == SLASH) {
-        v1 = vertexIndex(x, y + 1);
-        v2 = vertexIndex(x + 1, y);
-    } else {
-        v1 = vertexIndex(x, y);
-        v2 = vertexIndex(x + 1, y + 1);
-    }
+    // A slash joins the bottom-left and top-right corners, a backslash
+    // joins the top-left and bottom-right corners.
+    int W = vertexStride;
+    int tl = vertexId(cell->x, cell->y);
+    int slash = (value == SLASH);
+    int v1 = tl + slash * W;
+    int v2 = tl + 1 + (1 - slash) * W;
 
     return find(v1) == find(v2);
 }
 
+bool Board::wouldFormLoopReadOnly(Cell* cell, int value) const {
+    int W = vertexStride;
+    int tl = vertexId(cell->x, cell->y);
+    int slash = (value == SLASH);
+    int v1 = tl + slash * W;
+    int v2 = tl + 1 + (1 - slash) * W;
+
+    return findReadOnly(v1) == findReadOnly(v2);
+}
+
 bool Board::placeValue(Cell* cell, int value) {
     if (cell->value != UNKNOWN) {
         return true;
@@ -257,13 +337,13 @@ bool Board::placeValue(Cell* cell, int value) {
     int nonV1X, nonV1Y, nonV2X, nonV2Y;
 
     if (value == SLASH) {
-        v1 = vertexIndex(x, y + 1);
-        v2 = vertexIndex(x + 1, y);
+        v1 = vertexId(x, y + 1);
+        v2 = vertexId(x + 1, y);
         nonV1X = x; nonV1Y = y;         // top-left
         nonV2X = x + 1; nonV2Y = y + 1; // bottom-right
     } else {
-        v1 = vertexIndex(x, y);
-        v2 = vertexIndex(x + 1, y + 1);
+        v1 = vertexId(x, y);
+        v2 = vertexId(x + 1, y + 1);
         nonV1X = x + 1; nonV1Y = y;     // top-right
         nonV2X = x; nonV2Y = y + 1;     // bottom-left
     }
@@ -277,6 +357,7 @@ bool Board::placeValue(Cell* cell, int value) {
     decrExits(nonV2X, nonV2Y);
 
     cell->value = value;
+    unknownRemove(cellIndex(cell));
 
     // Update slashval for this cell's equivalence class
     int idx = cellIndex(cell);
@@ -287,31 +368,23 @@ bool Board::placeValue(Cell* cell, int value) {
 }
 
 void Board::decrExits(int vx, int vy) {
-    Vertex* vertex = getVertex(vx, vy);
+    Vertex* vertex = vertexAt(vx, vy);
     if (vertex->hasClue) {
         return;  // Clued vertices have fixed exits
     }
-    int idx = vertexIndex(vx, vy);
-    int root = find(idx);
-    exits[root]--;
+    int root = find(vertexId(vx, vy));
+    forests[root & 1].exits[root >> 1]--;
 }
 
 bool Board::isSolved() {
-    for (auto& cell : cells) {
-        if (cell->value == UNKNOWN) {
-            return false;
-        }
-    }
-    return true;
+    return numUnknown == 0;
 }
 
 bool Board::isValid() {
-    for (auto& vertex : vertices) {
-        if (vertex->hasClue) {
-            auto [current, _] = countTouches(vertex.get());
-            if (current > vertex->clue) {
-                return false;
-            }
+    for (Vertex* vertex : cluedVertices) {
+        auto [current, _] = countTouches(vertex);
+        if (current > vertex->clue) {
+            return false;
         }
     }
     return true;
@@ -321,12 +394,10 @@ bool Board::isValidSolution() {
     if (!isSolved()) {
         return false;
     }
-    for (auto& vertex : vertices) {
-        if (vertex->hasClue) {
-            auto [current, _] = countTouches(vertex.get());
-            if (current != vertex->clue) {
-                return false;
-            }
+    for (Vertex* vertex : cluedVertices) {
+        auto [current, _] = countTouches(vertex);
+        if (current != vertex->clue) {
+            return false;
         }
     }
     return true;
@@ -357,29 +428,143 @@ BoardState Board::saveState() {
     for (size_t i = 0; i < cells.size(); i++) {
         state.cellValues[i] = cells[i]->value;
     }
-    state.parent = parent;
-    state.rank = rank;
+    state.forests[0] = forests[0];
+    state.forests[1] = forests[1];
     state.equivParent = equivParent;
     state.equivRank = equivRank;
     state.slashval = slashval;
     state.vbitmap = vbitmap;
-    state.exits = exits;
-    state.border = border;
     return state;
 }
 
 void Board::restoreState(const BoardState& state) {
+    // Only cells whose known/unknown status changed touch the unknown set
     for (size_t i = 0; i < cells.size(); i++) {
-        cells[i]->value = state.cellValues[i];
+        int value = state.cellValues[i];
+        if (cells[i]->value == value) {
+            continue;
+        }
+        if (value == UNKNOWN) {
+            unknownInsert((int)i);
+        } else if (cells[i]->value == UNKNOWN) {
+            unknownRemove((int)i);
+        }
+        cells[i]->value = value;
     }
-    parent = state.parent;
-    rank = state.rank;
+    forests[0] = state.forests[0];
+    forests[1] = state.forests[1];
     equivParent = state.equivParent;
     equivRank = state.equivRank;
     slashval = state.slashval;
     vbitmap = state.vbitmap;
-    exits = state.exits;
-    border = state.border;
+}
+
+namespace {
+
+// Snapshot layout: parent and exits of both forests and equivParent as
+// Index, then cell values, slashval, vbitmap, equivRank, and rank and
+// border of both forests as bytes. The Index arrays come first so they
+// stay aligned within a record.
+template <typename Index>
+uint8_t* packIndices(const std::vector<int>& src, uint8_t* out) {
+    Index* dst = reinterpret_cast<Index*>(out);
+    for (size_t i = 0; i < src.size(); i++) {
+        dst[i] = (Index)src[i];
+    }
+    return out + src.size() * sizeof(Index);
+}
+
+template <typename Index>
+const uint8_t* unpackIndices(const uint8_t* in, std::vector<int>& dst) {
+    const Index* src = reinterpret_cast<const Index*>(in);
+    for (size_t i = 0; i < dst.size(); i++) {
+        dst[i] = src[i];
+    }
+    return in + dst.size() * sizeof(Index);
+}
+
+uint8_t* packBytes(const std::vector<uint8_t>& src, uint8_t* out) {
+    std::memcpy(out, src.data(), src.size());
+    return out + src.size();
+}
+
+const uint8_t* unpackBytes(const uint8_t* in, std::vector<uint8_t>& dst) {
+    std::memcpy(dst.data(), in, dst.size());
+    return in + dst.size();
+}
+
+}  // namespace
+
+size_t Board::snapshotWords() const {
+    size_t numCells = cells.size();
+    size_t numVertices = forests[0].parent.size() + forests[1].parent.size();
+    size_t indexBytes = narrowSnapshot() ? sizeof(int16_t) : sizeof(int32_t);
+    size_t bytes = indexBytes * (2 * numVertices + numCells) + 4 * numCells + 2 * numVertices;
+    return (bytes + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+}
+
+template <typename Index>
+void Board::saveSnapshotAs(uint8_t* out) const {
+    for (const VertexForest& forest : forests) {
+        out = packIndices<Index>(forest.parent, out);
+        out = packIndices<Index>(forest.exits, out);
+    }
+    out = packIndices<Index>(equivParent, out);
+    for (size_t i = 0; i < cells.size(); i++) {
+        *out++ = (uint8_t)cells[i]->value;
+    }
+    out = packBytes(slashval, out);
+    out = packBytes(vbitmap, out);
+    out = packBytes(equivRank, out);
+    for (const VertexForest& forest : forests) {
+        out = packBytes(forest.rank, out);
+        out = packBytes(forest.border, out);
+    }
+}
+
+template <typename Index>
+void Board::restoreSnapshotAs(const uint8_t* in) {
+    for (VertexForest& forest : forests) {
+        in = unpackIndices<Index>(in, forest.parent);
+        in = unpackIndices<Index>(in, forest.exits);
+    }
+    in = unpackIndices<Index>(in, equivParent);
+    // Only cells whose known/unknown status changed touch the unknown set
+    for (size_t i = 0; i < cells.size(); i++) {
+        int value = *in++;
+        if (cells[i]->value == value) {
+            continue;
+        }
+        if (value == UNKNOWN) {
+            unknownInsert((int)i);
+        } else if (cells[i]->value == UNKNOWN) {
+            unknownRemove((int)i);
+        }
+        cells[i]->value = value;
+    }
+    in = unpackBytes(in, slashval);
+    in = unpackBytes(in, vbitmap);
+    in = unpackBytes(in, equivRank);
+    for (VertexForest& forest : forests) {
+        in = unpackBytes(in, forest.rank);
+        in = unpackBytes(in, forest.border);
+    }
+}
+
+void Board::saveSnapshot(uint32_t* record) const {
+    if (narrowSnapshot()) {
+        saveSnapshotAs<int16_t>(reinterpret_cast<uint8_t*>(record));
+    } else {
+        saveSnapshotAs<int32_t>(reinterpret_cast<uint8_t*>(record));
+    }
+}
+
+void Board::restoreSnapshot(const uint32_t* record) {
+    if (narrowSnapshot()) {
+        restoreSnapshotAs<int16_t>(reinterpret_cast<const uint8_t*>(record));
+    } else {
+        restoreSnapshotAs<int32_t>(reinterpret_cast<const uint8_t*>(record));
+    }
 }
 
 int Board::getCellEquivRoot(Cell* cell) {
@@ -444,16 +629,15 @@ bool Board::vbitmapClear(Cell* cell, int bits) {
 }
 
 int Board::getVertexRoot(int vx, int vy) {
-    int idx = vertexIndex(vx, vy);
-    return find(idx);
+    return find(vertexId(vx, vy));
 }
 
 int Board::getVertexGroupExits(int vx, int vy) {
     int root = getVertexRoot(vx, vy);
-    return exits[root];
+    return forests[root & 1].exits[root >> 1];
 }
 
 bool Board::getVertexGroupBorder(int vx, int vy) {
     int root = getVertexRoot(vx, vy);
-    return border[root];
+    return forests[root & 1].border[root >> 1];
 }
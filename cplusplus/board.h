@@ -1,6 +1,9 @@
 #ifndef BOARD_H
 #define BOARD_H
 
+#include "geometry.h"
+#include "scratch.h"
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <memory>
@@ -9,6 +12,7 @@
 constexpr int UNKNOWN = 0;
 constexpr int SLASH = 1;     // /  - connects bottom-left to top-right
 constexpr int BACKSLASH = 2; // \  - connects top-left to bottom-right
+constexpr int OUTSIDE = 3;   // sentinel cell in the padding ring around the board
 
 // Vertex represents a corner point in a Slants puzzle
 struct Vertex {
@@ -27,6 +31,15 @@ struct Cell {
     Cell(int px, int py) : x(px), y(py), value(UNKNOWN) {}
 };
 
+// GivensStatus is the outcome of decoding a givens string
+enum class GivensStatus {
+    OK,
+    BAD_SIZE,       // width or height is not positive
+    BAD_CHARACTER,  // a character other than 0-4 or a-z
+    TOO_SHORT,      // fewer entries than vertices
+    TOO_LONG,       // more entries than vertices
+};
+
 // AdjacentCellInfo contains info about a cell adjacent to a vertex
 struct AdjacentCellInfo {
     Cell* cell;
@@ -34,51 +47,92 @@ struct AdjacentCellInfo {
     bool backslashTouches;
 };
 
-// BoardState holds a snapshot for backtracking
-struct BoardState {
-    std::vector<int> cellValues;
+// AdjacentList holds the up to four cells around a vertex
+using AdjacentList = InlineList<AdjacentCellInfo, 4>;
+
+// VertexForest is the union-find over the vertices of one checkerboard
+// parity. A diagonal always joins two vertices whose vx + vy have the same
+// parity, so vertex groups never mix parities and each parity is a forest
+// of its own. exits and border are kept at each group's root.
+struct VertexForest {
     std::vector<int> parent;
-    std::vector<int> rank;
-    std::vector<int> equivParent;
-    std::vector<int> equivRank;
-    std::vector<int> slashval;
-    std::vector<int> vbitmap;
+    std::vector<uint8_t> rank;
     std::vector<int> exits;
-    std::vector<bool> border;
+    std::vector<uint8_t> border;
+};
+
+// BoardState holds a snapshot for backtracking. Per-cell and per-vertex
+// flags use byte-wide types so snapshots of very large boards stay small.
+struct BoardState {
+    std::vector<uint8_t> cellValues;
+    VertexForest forests[2];
+    std::vector<int> equivParent;
+    std::vector<uint8_t> equivRank;
+    std::vector<uint8_t> slashval;
+    std::vector<uint8_t> vbitmap;
 };
 
 class Board {
 public:
     int width, height;
+    std::shared_ptr<const BoardGeometry> geometry;  // shared by all boards of this size
     std::vector<std::unique_ptr<Cell>> cells;
     std::vector<std::unique_ptr<Vertex>> vertices;
 
-    // Union-find for loop detection (vertex connectivity)
-    std::vector<int> parent;
-    std::vector<int> rank;
+    // Union-find for loop detection (vertex connectivity), one forest per
+    // vertex parity. Vertex ids number the vertices row-major with an odd
+    // row stride, so the low bit of an id is the vertex parity and the
+    // remaining bits are its slot in that parity's forest.
+    VertexForest forests[2];
+    int vertexStride;
 
     // Equivalence class tracking for cells
     std::vector<int> equivParent;
-    std::vector<int> equivRank;
-    std::vector<int> slashval;
+    std::vector<uint8_t> equivRank;
+    std::vector<uint8_t> slashval;
 
     // V-bitmap tracking
-    std::vector<int> vbitmap;
-
-    // Exits and border tracking
-    std::vector<int> exits;
-    std::vector<bool> border;
-
-    Board(int w, int h, const std::string& givensString);
-
-    // Cell access
+    std::vector<uint8_t> vbitmap;
+
+    // Sparse set of unknown cells: the first numUnknown entries of
+    // unknownDense are the unknown cells, unknownPos maps a cell index
+    // to its slot in unknownDense.
+    std::vector<Cell*> unknownDense;
+    std::vector<int> unknownPos;
+    int numUnknown;
+
+    // Scratch storage for rules; not part of the board state
+    RuleScratch scratch;
+
+    // fromGivens builds a board from run-length givens. On malformed input
+    // it returns nullptr and status says why.
+    static std::unique_ptr<Board> fromGivens(int w, int h, const std::string& givensString,
+                                             GivensStatus& status);
+
+    // decodeGivens walks run-length givens once, calling store(vertex, clue)
+    // for every clued vertex; vertices covered by a run of letters are left
+    // alone. It checks the characters and that exactly numVertices entries
+    // are described.
+    template <typename Store>
+    static GivensStatus decodeGivens(const std::string& givensString, int numVertices, Store store);
+
+    // Cell access (bounds-checked, nullptr when off the board)
     Cell* getCell(int x, int y);
     Vertex* getVertex(int vx, int vy);
-    std::vector<Vertex*> getCluedVertices();
+
+    // Unchecked access through the padded grids. cellAt accepts x in
+    // [-1, width] and y in [-1, height]; vertexAt accepts vx in
+    // [-1, width + 1] and vy in [-1, height + 1]. Positions off the board
+    // return the OUTSIDE sentinel cell or the clueless sentinel vertex.
+    Cell* cellAt(int x, int y) const { return cellGrid[(y + 1) * (width + 2) + x + 1]; }
+    Vertex* vertexAt(int vx, int vy) const { return vertexGrid[(vy + 1) * (width + 3) + vx + 1]; }
+    const std::vector<Vertex*>& getCluedVertices() const { return cluedVertices; }
+    const std::vector<Vertex*>& getCluedVertices(int clue) const { return cluedByValue[clue]; }
     std::vector<Cell*> getUnknownCells();
+    int getUnknownCount() const { return numUnknown; }
 
     // Adjacent cell info
-    std::vector<AdjacentCellInfo> getAdjacentCellsForVertex(Vertex* vertex);
+    AdjacentList getAdjacentCellsForVertex(Vertex* vertex);
     std::pair<int, int> countTouches(Vertex* vertex);
 
     // Cell corners
@@ -86,6 +140,9 @@ public:
 
     // Loop detection
     bool wouldFormLoop(Cell* cell, int value);
+    // Same test without path compression, safe to call from several
+    // threads while no thread modifies the board
+    bool wouldFormLoopReadOnly(Cell* cell, int value) const;
     bool placeValue(Cell* cell, int value);
 
     // Board state
@@ -98,6 +155,15 @@ public:
     BoardState saveState();
     void restoreState(const BoardState& state);
 
+    // Fixed-size snapshots for the BF search arena. A snapshot holds the same
+    // state as BoardState in snapshotWords() 32-bit words; union-find links
+    // and exit counts are stored as int16_t when each parity forest has
+    // fewer than SNAPSHOT_NARROW_VERTICES vertices.
+    static constexpr int SNAPSHOT_NARROW_VERTICES = 8192;
+    size_t snapshotWords() const;
+    void saveSnapshot(uint32_t* record) const;
+    void restoreSnapshot(const uint32_t* record);
+
     // Equivalence classes
     int getCellEquivRoot(Cell* cell);
     bool markCellsEquivalent(Cell* cell1, Cell* cell2);
@@ -107,24 +173,73 @@ public:
     int vbitmapGet(Cell* cell);
     bool vbitmapClear(Cell* cell, int bits);
 
-    // Exits/border
+    // Exits/border. Roots are vertex ids, unique across both forests.
     int getVertexRoot(int vx, int vy);
     int getVertexGroupExits(int vx, int vy);
     bool getVertexGroupBorder(int vx, int vy);
 
 private:
-    std::vector<int> decodeGivens(const std::string& givensString);
+    // Builds the cells and clueless vertices; fromGivens fills in the clues
+    // and then calls init
+    Board(int w, int h);
+    void init();
+
+    // Padded grids with a one-entry ring of sentinels around the board
+    std::vector<Cell*> cellGrid;
+    std::vector<Vertex*> vertexGrid;
+    Cell sentinelCell{-1, -1};
+    Vertex sentinelVertex{-1, -1, -1};
+
+    // Clued vertices (all, and grouped by clue value), built once at construction
+    std::vector<Vertex*> cluedVertices;
+    std::vector<Vertex*> cluedByValue[5];
+
     void initUnionFind();
     void initEquivalence();
     void initVBitmap();
     void initExitsBorder();
-
-    int find(int x);
-    bool unite(int x, int y);
+    void initPaddedGrids();
+    void initCluedVertices();
+    void initUnknownSet();
+
+    // Forest 0 is never the smaller one, so it decides the index width
+    bool narrowSnapshot() const { return forests[0].parent.size() < (size_t)SNAPSHOT_NARROW_VERTICES; }
+    template <typename Index>
+    void saveSnapshotAs(uint8_t* out) const;
+    template <typename Index>
+    void restoreSnapshotAs(const uint8_t* in);
+
+    int find(int id);
+    int findReadOnly(int id) const;
+    bool unite(int id1, int id2);
+    int vertexId(int vx, int vy) const { return vy * vertexStride + vx; }
     int vertexIndex(int vx, int vy);
     int cellIndex(Cell* cell);
     int equivFind(int x);
     void decrExits(int vx, int vy);
+    void unknownRemove(int idx);
+    void unknownInsert(int idx);
 };
 
+template <typename Store>
+GivensStatus Board::decodeGivens(const std::string& givensString, int numVertices, Store store) {
+    int v = 0;
+    for (char c : givensString) {
+        if (c >= '0' && c <= '4') {
+            if (v >= numVertices) {
+                return GivensStatus::TOO_LONG;
+            }
+            store(v++, c - '0');
+        } else if (c >= 'a' && c <= 'z') {
+            v += c - 'a' + 1;
+            if (v > numVertices) {
+                return GivensStatus::TOO_LONG;
+            }
+        } else {
+            return GivensStatus::BAD_CHARACTER;
+        }
+    }
+    return (v == numVertices) ? GivensStatus::OK : GivensStatus::TOO_SHORT;
+}
+
 #endif // BOARD_H
@@ -0,0 +1,83 @@
+#include "checkpoint.h"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+bool Checkpoint::save(const std::string& path) const {
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath);
+        if (!out.is_open()) {
+            return false;
+        }
+        out.precision(17);
+        out << "run " << runKey << "\n";
+        out << "completed " << completed << "\n";
+        out << "output_bytes " << outputBytes << "\n";
+        out << "solved " << solvedCount << "\n";
+        out << "unsolved " << unsolvedCount << "\n";
+        out << "mult " << multCount << "\n";
+        out << "work_score " << totalWorkScore << "\n";
+        out << "unsolved_squares " << totalUnsolvedSquares << "\n";
+        out << "tiers " << tierCounts[1] << " " << tierCounts[2] << " " << tierCounts[3] << "\n";
+        out << "elapsed " << elapsedTime << "\n";
+        out << "unsolved_records";
+        for (int record : unsolvedRecords) {
+            out << " " << record;
+        }
+        out << "\n";
+        out.flush();
+        if (!out) {
+            return false;
+        }
+    }
+    return std::rename(tmpPath.c_str(), path.c_str()) == 0;
+}
+
+bool Checkpoint::load(const std::string& path) {
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        return false;
+    }
+    std::string line;
+    int fields = 0;
+    while (std::getline(in, line)) {
+        std::istringstream iss(line);
+        std::string key;
+        iss >> key;
+        if (key == "run") {
+            std::getline(iss >> std::ws, runKey);
+        } else if (key == "completed") {
+            iss >> completed;
+        } else if (key == "output_bytes") {
+            iss >> outputBytes;
+        } else if (key == "solved") {
+            iss >> solvedCount;
+        } else if (key == "unsolved") {
+            iss >> unsolvedCount;
+        } else if (key == "mult") {
+            iss >> multCount;
+        } else if (key == "work_score") {
+            iss >> totalWorkScore;
+        } else if (key == "unsolved_squares") {
+            iss >> totalUnsolvedSquares;
+        } else if (key == "tiers") {
+            iss >> tierCounts[1] >> tierCounts[2] >> tierCounts[3];
+        } else if (key == "elapsed") {
+            iss >> elapsedTime;
+        } else if (key == "unsolved_records") {
+            unsolvedRecords.clear();
+            int record;
+            while (iss >> record) {
+                unsolvedRecords.push_back(record);
+            }
+        } else {
+            return false;
+        }
+        if (iss.fail() && !iss.eof()) {
+            return false;
+        }
+        fields++;
+    }
+    return fields == 11;
+}
@@ -0,0 +1,32 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <string>
+#include <vector>
+
+// Checkpoint is the saved progress of a solve run: how many of the selected
+// records are done, the summary accumulators over them, and how much of the
+// result output belongs to them
+struct Checkpoint {
+    std::string runKey;            // input file and options; a resume must match
+    int completed = 0;             // records finished, counted from the first selected one
+    long long outputBytes = 0;     // length of the result output covering them
+    int solvedCount = 0;
+    int unsolvedCount = 0;
+    int multCount = 0;
+    int totalWorkScore = 0;
+    int totalUnsolvedSquares = 0;
+    int tierCounts[4] = {0, 0, 0, 0};  // indexed by tier, 1-3 used
+    double elapsedTime = 0;
+    std::vector<int> unsolvedRecords;  // indices of unsolved records, for -ou
+
+    // save writes the checkpoint to a temporary file and renames it over
+    // path, so a crash leaves either the old or the new checkpoint
+    bool save(const std::string& path) const;
+
+    // load reads a checkpoint written by save. Returns false if path is
+    // missing or malformed.
+    bool load(const std::string& path);
+};
+
+#endif // CHECKPOINT_H
@@ -0,0 +1,110 @@
+#include "component.h"
+#include <algorithm>
+#include <numeric>
+
+std::vector<std::vector<Cell*>> SplitComponents(Board* board, const std::vector<Cell*>& cells) {
+    int n = (int)cells.size();
+    std::vector<Cell*> sorted(cells);
+    std::sort(sorted.begin(), sorted.end(), [board](Cell* a, Cell* b) {
+        return a->y * board->width + a->x < b->y * board->width + b->x;
+    });
+
+    // Union cells that share a vertex group, through the first cell seen
+    // at each group root
+    std::vector<int> parent(n);
+    std::iota(parent.begin(), parent.end(), 0);
+    auto findRoot = [&parent](int i) {
+        while (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    };
+    EpochGrid<int>& owner = board->scratch.vertexSlot;
+    owner.reset((board->height + 1) * board->vertexStride, -1);
+    for (int i = 0; i < n; i++) {
+        for (int dy = 0; dy <= 1; dy++) {
+            for (int dx = 0; dx <= 1; dx++) {
+                int& first = owner[board->getVertexRoot(sorted[i]->x + dx, sorted[i]->y + dy)];
+                if (first < 0) {
+                    first = i;
+                } else {
+                    parent[findRoot(i)] = findRoot(first);
+                }
+            }
+        }
+    }
+
+    std::vector<int> slot(n, -1);
+    std::vector<std::vector<Cell*>> components;
+    for (int i = 0; i < n; i++) {
+        int root = findRoot(i);
+        if (slot[root] < 0) {
+            slot[root] = (int)components.size();
+            components.emplace_back();
+        }
+        components[slot[root]].push_back(sorted[i]);
+    }
+    std::stable_sort(components.begin(), components.end(),
+                     [](const std::vector<Cell*>& a, const std::vector<Cell*>& b) { return a.size() < b.size(); });
+    return components;
+}
+
+std::vector<int> ComponentKey(Board* board, const std::vector<Cell*>& component) {
+    std::vector<int> key;
+    key.reserve(1 + 5 * component.size());
+    key.push_back((int)component.size());
+    for (Cell* cell : component) {
+        key.push_back(cell->y * board->width + cell->x);
+    }
+
+    // Each corner is its group number and clue residual (0 for no clue)
+    EpochGrid<int>& group = board->scratch.vertexSlot;
+    group.reset((board->height + 1) * board->vertexStride, -1);
+    int numGroups = 0;
+    for (Cell* cell : component) {
+        for (int dy = 0; dy <= 1; dy++) {
+            for (int dx = 0; dx <= 1; dx++) {
+                int& number = group[board->getVertexRoot(cell->x + dx, cell->y + dy)];
+                if (number < 0) {
+                    number = numGroups++;
+                }
+                Vertex* vertex = board->vertexAt(cell->x + dx, cell->y + dy);
+                int residual = vertex->hasClue ? vertex->clue - board->countTouches(vertex).first + 1 : 0;
+                key.push_back(number * 8 + residual);
+            }
+        }
+    }
+    return key;
+}
+
+size_t ComponentCache::KeyHash::operator()(const std::vector<int>& key) const {
+    uint64_t hash = 14695981039346656037ULL;
+    for (int value : key) {
+        hash = (hash ^ (uint32_t)value) * 1099511628211ULL;
+    }
+    return (size_t)hash;
+}
+
+const ComponentResult* ComponentCache::find(const std::vector<int>& key) {
+    auto it = entries.find(key);
+    if (it == entries.end()) {
+        return nullptr;
+    }
+    useOrder.splice(useOrder.begin(), useOrder, it->second.use);
+    return &it->second.result;
+}
+
+void ComponentCache::insert(const std::vector<int>& key, const ComponentResult& result) {
+    if (capacity == 0 || entries.count(key)) {
+        return;
+    }
+    if (entries.size() >= capacity) {
+        auto oldest = entries.find(*useOrder.back());
+        useOrder.pop_back();
+        entries.erase(oldest);
+    }
+    auto it = entries.emplace(key, Entry{result, {}}).first;
+    useOrder.push_front(&it->first);
+    it->second.use = useOrder.begin();
+}
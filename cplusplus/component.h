@@ -0,0 +1,62 @@
+#ifndef COMPONENT_H
+#define COMPONENT_H
+
+#include "board.h"
+#include "scratch.h"
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+// Unknown cells interact only through the vertex groups at their corners:
+// a clue is a vertex, and a loop can only close through groups that the
+// new diagonals touch. Cells whose corners share no group are therefore
+// independent, and the solutions of the board are the product of the
+// solutions of each component.
+
+// ComponentResult is the number of solutions of a component, saturated at
+// two, with the values of its cells in one of them
+struct ComponentResult {
+    int count = 0;                // 0, 1, or 2 for "two or more"
+    std::vector<uint8_t> values;  // per cell of the component, when count is not 0
+};
+
+// SplitComponents partitions cells (all unknown) into components, each in
+// increasing cell index order; the components are ordered smallest first
+std::vector<std::vector<Cell*>> SplitComponents(Board* board, const std::vector<Cell*>& cells);
+
+// ComponentKey describes everything the solutions of a component depend on:
+// its cells, the clue residual on each corner, and which corners share a
+// vertex group (numbered in order of first appearance). Equal keys have the
+// same solutions wherever they occur in the search.
+std::vector<int> ComponentKey(Board* board, const std::vector<Cell*>& component);
+
+// ComponentCache maps component keys to results. It holds at most capacity
+// entries and evicts the least recently used one when full.
+class ComponentCache {
+public:
+    explicit ComponentCache(size_t capacity) : capacity(capacity) {}
+
+    // find returns the cached result for key, or nullptr, and marks it used
+    const ComponentResult* find(const std::vector<int>& key);
+
+    // insert stores result under key, evicting if needed
+    void insert(const std::vector<int>& key, const ComponentResult& result);
+
+    size_t size() const { return entries.size(); }
+
+private:
+    struct KeyHash {
+        size_t operator()(const std::vector<int>& key) const;
+    };
+    struct Entry {
+        ComponentResult result;
+        std::list<const std::vector<int>*>::iterator use;
+    };
+
+    size_t capacity;
+    std::unordered_map<std::vector<int>, Entry, KeyHash> entries;
+    std::list<const std::vector<int>*> useOrder;  // most recently used first
+};
+
+#endif // COMPONENT_H
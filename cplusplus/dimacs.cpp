@@ -0,0 +1,314 @@
+#include "dimacs.h"
+#include "board.h"
+#include <map>
+#include <sstream>
+#include <vector>
+
+// Clause is a disjunction of DIMACS literals
+using Clause = std::vector<int>;
+
+// CnfEncoding numbers the unknown cells of a propagated board and builds
+// the clauses that describe its completions
+class CnfEncoding {
+public:
+    CnfEncoding(Board* board, bool acyclic);
+
+    void write(std::ostream& out) const;
+
+    // slashLiteral is the literal meaning "cell holds '/'", or 0 for known cells
+    int slashLiteral(int cell) const { return cellLiteral[cell]; }
+    int numCellVariables() const { return numCellVars; }
+
+private:
+    Board* board;
+    std::vector<int> cellLiteral;
+    int numCellVars;
+    int numVars;
+    std::vector<Clause> clauses;
+
+    int newVariable() { return ++numVars; }
+    void addClueConstraints();
+    void addLoopUnits();
+    void addAcyclicity();
+    void addExactly(const std::vector<int>& literals, int count);
+    void addAtMostOne(const std::vector<int>& literals);
+};
+
+CnfEncoding::CnfEncoding(Board* b, bool acyclic)
+    : board(b), cellLiteral(b->cells.size(), 0), numCellVars(0), numVars(0) {
+    // One variable per equivalence class; equivalent cells hold the same value
+    std::map<int, int> classVariable;
+    for (Cell* cell : board->getUnknownCells()) {
+        int root = board->getCellEquivRoot(cell);
+        auto [it, inserted] = classVariable.try_emplace(root, 0);
+        if (inserted) {
+            it->second = newVariable();
+            int known = board->getEquivalenceClassValue(cell);
+            if (known != 0) {
+                clauses.push_back({known == SLASH ? it->second : -it->second});
+            }
+        }
+        cellLiteral[cell->y * board->width + cell->x] = it->second;
+    }
+    numCellVars = numVars;
+
+    addClueConstraints();
+    addLoopUnits();
+    if (acyclic) {
+        addAcyclicity();
+    }
+}
+
+// addExactly requires exactly count of literals to be true. Clues have at
+// most four unknown cells, so every subset is listed directly.
+void CnfEncoding::addExactly(const std::vector<int>& literals, int count) {
+    int k = (int)literals.size();
+    if (count < 0 || count > k) {
+        clauses.push_back({});
+        return;
+    }
+    for (int mask = 0; mask < (1 << k); mask++) {
+        int size = __builtin_popcount(mask);
+        // At most count: any count + 1 of them has a false literal
+        if (size == count + 1) {
+            Clause clause;
+            for (int i = 0; i < k; i++) {
+                if (mask & (1 << i)) {
+                    clause.push_back(-literals[i]);
+                }
+            }
+            clauses.push_back(clause);
+        }
+        // At least count: any k - count + 1 of them has a true literal
+        if (size == k - count + 1) {
+            Clause clause;
+            for (int i = 0; i < k; i++) {
+                if (mask & (1 << i)) {
+                    clause.push_back(literals[i]);
+                }
+            }
+            clauses.push_back(clause);
+        }
+    }
+}
+
+// addAtMostOne uses pairwise clauses for short lists and a sequential
+// counter for long ones
+void CnfEncoding::addAtMostOne(const std::vector<int>& literals) {
+    int n = (int)literals.size();
+    if (n <= 5) {
+        for (int i = 0; i < n; i++) {
+            for (int j = i + 1; j < n; j++) {
+                clauses.push_back({-literals[i], -literals[j]});
+            }
+        }
+        return;
+    }
+    // seen_i is true once one of literals[0..i] is true
+    int previous = 0;
+    for (int i = 0; i < n; i++) {
+        int seen = newVariable();
+        clauses.push_back({-literals[i], seen});
+        if (previous) {
+            clauses.push_back({-previous, seen});
+            clauses.push_back({-previous, -literals[i]});
+        }
+        previous = seen;
+    }
+}
+
+void CnfEncoding::addClueConstraints() {
+    for (Vertex* vertex : board->getCluedVertices()) {
+        int needed = vertex->clue;
+        std::vector<int> touchLiterals;
+        for (auto& adj : board->getAdjacentCellsForVertex(vertex)) {
+            int value = adj.cell->value;
+            if (value == UNKNOWN) {
+                int lit = slashLiteral(adj.cell->y * board->width + adj.cell->x);
+                touchLiterals.push_back(adj.slashTouches ? lit : -lit);
+            } else if ((value == SLASH) == adj.slashTouches) {
+                needed--;
+            }
+        }
+        if (!touchLiterals.empty() || needed != 0) {
+            addExactly(touchLiterals, needed);
+        }
+    }
+}
+
+void CnfEncoding::addLoopUnits() {
+    for (Cell* cell : board->getUnknownCells()) {
+        int lit = slashLiteral(cell->y * board->width + cell->x);
+        if (board->wouldFormLoop(cell, SLASH)) {
+            clauses.push_back({-lit});
+        }
+        if (board->wouldFormLoop(cell, BACKSLASH)) {
+            clauses.push_back({lit});
+        }
+    }
+}
+
+void CnfEncoding::addAcyclicity() {
+    // Vertices already joined by placed diagonals act as one node
+    struct Edge {
+        int a, b;      // nodes
+        int chosen;    // literal selecting this diagonal
+    };
+    std::map<int, int> nodeOfRoot;
+    std::vector<Edge> edges;
+    auto node = [&](int vx, int vy) {
+        int root = board->getVertexRoot(vx, vy);
+        auto [it, inserted] = nodeOfRoot.try_emplace(root, (int)nodeOfRoot.size());
+        return it->second;
+    };
+    for (Cell* cell : board->getUnknownCells()) {
+        int lit = slashLiteral(cell->y * board->width + cell->x);
+        int x = cell->x;
+        int y = cell->y;
+        int slashA = node(x, y + 1), slashB = node(x + 1, y);
+        int backA = node(x, y), backB = node(x + 1, y + 1);
+        // Diagonals inside one node are excluded by the loop units
+        if (slashA != slashB) {
+            edges.push_back({slashA, slashB, lit});
+        }
+        if (backA != backB) {
+            edges.push_back({backA, backB, -lit});
+        }
+    }
+
+    // A forest can be oriented so that every node has at most one parent
+    int numNodes = (int)nodeOfRoot.size();
+    std::vector<std::vector<int>> parentChoices(numNodes);
+    std::vector<std::pair<int, int>> arcs;  // (orientation literal, edge)
+    for (size_t e = 0; e < edges.size(); e++) {
+        const Edge& edge = edges[e];
+        int towardsB = newVariable();
+        int towardsA = newVariable();
+        clauses.push_back({-towardsB, edge.chosen});
+        clauses.push_back({-towardsA, edge.chosen});
+        clauses.push_back({-edge.chosen, towardsB, towardsA});
+        clauses.push_back({-towardsB, -towardsA});
+        parentChoices[edge.a].push_back(towardsB);
+        parentChoices[edge.b].push_back(towardsA);
+        arcs.push_back({towardsB, (int)e});
+        arcs.push_back({towardsA, -(int)e - 1});
+    }
+    for (const auto& choices : parentChoices) {
+        addAtMostOne(choices);
+    }
+
+    // Unary levels: atLeast[n][d - 1] means level(n) >= d, for d in 1..numNodes-1.
+    // A child's level is above its parent's, so no directed cycle survives.
+    int maxLevel = numNodes - 1;
+    std::vector<std::vector<int>> atLeast(numNodes);
+    for (int n = 0; n < numNodes; n++) {
+        for (int d = 1; d <= maxLevel; d++) {
+            atLeast[n].push_back(newVariable());
+            if (d > 1) {
+                clauses.push_back({-atLeast[n][d - 1], atLeast[n][d - 2]});
+            }
+        }
+    }
+    for (const auto& [orientation, code] : arcs) {
+        const Edge& edge = edges[code >= 0 ? code : -code - 1];
+        int child = (code >= 0) ? edge.a : edge.b;
+        int parent = (code >= 0) ? edge.b : edge.a;
+        for (int d = 0; d <= maxLevel; d++) {
+            Clause clause = {-orientation};
+            if (d > 0) {
+                clause.push_back(-atLeast[parent][d - 1]);
+            }
+            if (d < maxLevel) {
+                clause.push_back(atLeast[child][d]);
+            }
+            clauses.push_back(clause);
+        }
+    }
+}
+
+void CnfEncoding::write(std::ostream& out) const {
+    out << "p cnf " << numVars << " " << clauses.size() << "\n";
+    for (const auto& clause : clauses) {
+        for (int lit : clause) {
+            out << lit << " ";
+        }
+        out << "0\n";
+    }
+}
+
+// propagateForCnf builds the board and applies the rules up to tier 2
+static std::unique_ptr<Board> propagateForCnf(const std::string& givensString, int width, int height) {
+    GivensStatus status;
+    auto board = Board::fromGivens(width, height, givensString, status);
+    if (board) {
+        SolveOptions options;
+        options.maxTier = 2;
+        Propagate(board.get(), options);
+    }
+    return board;
+}
+
+bool ExportCnf(const std::string& givensString, int width, int height, bool acyclic, std::ostream& out) {
+    auto board = propagateForCnf(givensString, width, height);
+    if (!board) {
+        return false;
+    }
+    CnfEncoding encoding(board.get(), acyclic);
+    out << "c slants " << width << "x" << height << " " << givensString << "\n";
+    out << "c variables 1.." << encoding.numCellVariables() << " are cells (true = '/')\n";
+    encoding.write(out);
+    return true;
+}
+
+SolveResult ImportModel(const std::string& givensString, int width, int height, std::istream& model) {
+    auto board = propagateForCnf(givensString, width, height);
+    if (!board) {
+        return {"unsolved", "", 0, 0};
+    }
+    CnfEncoding encoding(board.get(), false);
+
+    // Accept "s"/"v" lines as well as bare SAT/UNSAT and literal lists
+    std::vector<int8_t> value(encoding.numCellVariables() + 1, -1);
+    bool unsat = false;
+    std::string line;
+    while (std::getline(model, line)) {
+        std::istringstream iss(line);
+        std::string token;
+        while (iss >> token) {
+            if (token == "c") {
+                break;
+            }
+            if (token == "UNSAT" || token == "UNSATISFIABLE") {
+                unsat = true;
+            }
+            if (token[0] != '-' && !isdigit((unsigned char)token[0])) {
+                continue;
+            }
+            int lit;
+            try {
+                lit = std::stoi(token);
+            } catch (...) {
+                return {"bad_model", board->toSolutionString(), 0, 0};
+            }
+            int var = std::abs(lit);
+            if (var >= 1 && var < (int)value.size()) {
+                value[var] = lit > 0;
+            }
+        }
+    }
+    if (unsat) {
+        return {"unsat", board->toSolutionString(), 0, 0};
+    }
+
+    for (Cell* cell : board->getUnknownCells()) {
+        int lit = encoding.slashLiteral(cell->y * width + cell->x);
+        if (value[lit] < 0) {
+            return {"incomplete", board->toSolutionString(), 0, 0};
+        }
+        if (!board->placeValue(cell, value[lit] ? SLASH : BACKSLASH)) {
+            return {"loop", board->toSolutionString(), 0, 0};
+        }
+    }
+    std::string status = board->isValidSolution() ? "solved" : "invalid";
+    return {status, board->toSolutionString(), 0, 0};
+}
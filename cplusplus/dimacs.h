@@ -0,0 +1,25 @@
+#ifndef DIMACS_H
+#define DIMACS_H
+
+#include "solver.h"
+#include <iostream>
+#include <string>
+
+// ExportCnf propagates a puzzle with the rules up to tier 2 and writes the
+// remaining unknown cells to out as DIMACS CNF. Variables 1..n are the
+// equivalence classes of unknown cells (true = '/'), numbered in board
+// order. Clues become exact cardinality constraints; diagonals that would
+// close a loop become unit clauses. With acyclic, a complete acyclicity
+// encoding is added: every chosen diagonal is oriented towards a parent,
+// every vertex group has at most one parent, and unary levels forbid
+// directed cycles. Returns false if the givens are malformed.
+bool ExportCnf(const std::string& givensString, int width, int height, bool acyclic, std::ostream& out);
+
+// ImportModel reads a SAT solver's output for a CNF written by ExportCnf
+// (with or without acyclic), places the cells it assigns and checks the
+// board with Board::isValidSolution. status is "solved", "unsat",
+// "invalid" (clues not met), "loop", "incomplete" (cells left unassigned)
+// or "bad_model".
+SolveResult ImportModel(const std::string& givensString, int width, int height, std::istream& model);
+
+#endif // DIMACS_H
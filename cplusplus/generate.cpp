@@ -0,0 +1,94 @@
+#include "generate.h"
+#include "board.h"
+#include <algorithm>
+#include <numeric>
+
+namespace {
+
+int findRoot(std::vector<int>& parent, int x) {
+    while (parent[x] != x) {
+        parent[x] = parent[parent[x]];
+        x = parent[x];
+    }
+    return x;
+}
+
+}  // namespace
+
+std::vector<int> GenerateSolution(int width, int height, std::mt19937& rng) {
+    int W = width + 1;
+    std::vector<int> parent(W * (height + 1));
+    std::iota(parent.begin(), parent.end(), 0);
+
+    std::vector<int> order(width * height);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), rng);
+
+    std::vector<int> solution(width * height);
+    for (int idx : order) {
+        int x = idx % width;
+        int y = idx / width;
+        int value = (rng() & 1) ? SLASH : BACKSLASH;
+        for (int attempt = 0; attempt < 2; attempt++) {
+            int v1 = (value == SLASH) ? (y + 1) * W + x : y * W + x;
+            int v2 = (value == SLASH) ? y * W + x + 1 : (y + 1) * W + x + 1;
+            int r1 = findRoot(parent, v1);
+            int r2 = findRoot(parent, v2);
+            if (r1 != r2) {
+                parent[r1] = r2;
+                solution[idx] = value;
+                break;
+            }
+            value = (value == SLASH) ? BACKSLASH : SLASH;
+        }
+    }
+    return solution;
+}
+
+std::vector<int> SolutionClues(int width, int height, const std::vector<int>& solution) {
+    std::vector<int> clues;
+    clues.reserve((width + 1) * (height + 1));
+    for (int vy = 0; vy <= height; vy++) {
+        for (int vx = 0; vx <= width; vx++) {
+            int touches = 0;
+            if (vx > 0 && vy > 0 && solution[(vy - 1) * width + vx - 1] == BACKSLASH) touches++;
+            if (vx < width && vy > 0 && solution[(vy - 1) * width + vx] == SLASH) touches++;
+            if (vx > 0 && vy < height && solution[vy * width + vx - 1] == SLASH) touches++;
+            if (vx < width && vy < height && solution[vy * width + vx] == BACKSLASH) touches++;
+            clues.push_back(touches);
+        }
+    }
+    return clues;
+}
+
+std::string EncodeGivens(const std::vector<int>& clues) {
+    std::string givens;
+    int run = 0;
+    auto flushRun = [&]() {
+        while (run > 0) {
+            int n = std::min(run, 26);
+            givens += (char)('a' + n - 1);
+            run -= n;
+        }
+    };
+
+    for (int clue : clues) {
+        if (clue < 0) {
+            run++;
+        } else {
+            flushRun();
+            givens += (char)('0' + clue);
+        }
+    }
+    flushRun();
+    return givens;
+}
+
+std::string SolutionString(const std::vector<int>& solution) {
+    std::string result;
+    result.reserve(solution.size());
+    for (int value : solution) {
+        result += (value == SLASH) ? '/' : '\\';
+    }
+    return result;
+}
@@ -0,0 +1,23 @@
+#ifndef GENERATE_H
+#define GENERATE_H
+
+#include <random>
+#include <string>
+#include <vector>
+
+// GenerateSolution fills every cell with a random diagonal, switching to the
+// other diagonal whenever the first choice would close a loop. At most one
+// of the two diagonals of a cell can close a loop, so this never fails.
+// Returns SLASH or BACKSLASH per cell, row by row.
+std::vector<int> GenerateSolution(int width, int height, std::mt19937& rng);
+
+// SolutionClues returns the touch count of every vertex of a solution, row by row
+std::vector<int> SolutionClues(int width, int height, const std::vector<int>& solution);
+
+// EncodeGivens RLE-encodes vertex clues; -1 marks a vertex without a clue
+std::string EncodeGivens(const std::vector<int>& clues);
+
+// SolutionString renders a solution as '/' and '\' characters
+std::string SolutionString(const std::vector<int>& solution);
+
+#endif // GENERATE_H
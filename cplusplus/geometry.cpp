@@ -0,0 +1,63 @@
+#include "geometry.h"
+#include <map>
+#include <mutex>
+#include <utility>
+
+BoardGeometry::BoardGeometry(int w, int h)
+    : width(w), height(h), numCells(w * h), numVertices((w + 1) * (h + 1)) {
+    int W = width + 1;
+
+    borderMask.resize(numVertices, 0);
+    vertexSlot.resize(numVertices);
+    for (int vy = 0; vy <= height; vy++) {
+        for (int vx = 0; vx <= width; vx++) {
+            int v = vy * W + vx;
+            borderMask[v] = (vy == 0 || vy == height || vx == 0 || vx == width);
+            vertexSlot[v] = (vy + 1) * (width + 3) + vx + 1;
+        }
+    }
+
+    cellCorners.resize(numCells);
+    cellSlot.resize(numCells);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            int c = y * width + x;
+            int tl = y * W + x;
+            cellCorners[c] = {tl, tl + 1, tl + W, tl + W + 1};
+            cellSlot[c] = (y + 1) * (width + 2) + x + 1;
+        }
+    }
+
+    // The cell above-left of a vertex has it as its bottom-right corner, so
+    // its backslash touches; likewise for the other three.
+    const int dx[4] = {-1, 0, -1, 0};
+    const int dy[4] = {-1, -1, 0, 0};
+    const bool slashTouches[4] = {false, true, true, false};
+    neighbourStart.reserve(numVertices + 1);
+    neighbours.reserve(numCells * 4);
+    for (int vy = 0; vy <= height; vy++) {
+        for (int vx = 0; vx <= width; vx++) {
+            neighbourStart.push_back((int)neighbours.size());
+            for (int i = 0; i < 4; i++) {
+                int x = vx + dx[i];
+                int y = vy + dy[i];
+                if (x >= 0 && x < width && y >= 0 && y < height) {
+                    neighbours.push_back({y * width + x, slashTouches[i]});
+                }
+            }
+        }
+    }
+    neighbourStart.push_back((int)neighbours.size());
+}
+
+std::shared_ptr<const BoardGeometry> BoardGeometry::get(int width, int height) {
+    static std::mutex mutex;
+    static std::map<std::pair<int, int>, std::shared_ptr<const BoardGeometry>> cache;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& entry = cache[{width, height}];
+    if (!entry) {
+        entry.reset(new BoardGeometry(width, height));
+    }
+    return entry;
+}
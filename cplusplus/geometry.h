@@ -0,0 +1,52 @@
+#ifndef GEOMETRY_H
+#define GEOMETRY_H
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// VertexNeighbour is a cell around a vertex and whether its slash (rather
+// than its backslash) touches the vertex
+struct VertexNeighbour {
+    int cell;
+    bool slashTouches;
+};
+
+// BoardGeometry holds the tables that depend only on a board's width and
+// height. Instances are immutable and shared by every board of that size;
+// get them from BoardGeometry::get.
+class BoardGeometry {
+public:
+    int width, height;
+    int numCells, numVertices;
+
+    // Per vertex: 1 if the vertex is on the edge of the board
+    std::vector<uint8_t> borderMask;
+
+    // Per cell: corner vertex indices (top-left, top-right, bottom-left,
+    // bottom-right)
+    std::vector<std::array<int, 4>> cellCorners;
+
+    // Slots of each cell and vertex in the sentinel-padded grids
+    std::vector<int> cellSlot;
+    std::vector<int> vertexSlot;
+
+    // [neighboursBegin(v), neighboursEnd(v)) are the cells around vertex v in
+    // the order top-left, top-right, bottom-left, bottom-right, skipping
+    // cells off the board
+    const VertexNeighbour* neighboursBegin(int v) const { return neighbours.data() + neighbourStart[v]; }
+    const VertexNeighbour* neighboursEnd(int v) const { return neighbours.data() + neighbourStart[v + 1]; }
+
+    // get returns the shared geometry for a board size, building it on first
+    // use. Safe to call from several threads.
+    static std::shared_ptr<const BoardGeometry> get(int width, int height);
+
+private:
+    std::vector<int> neighbourStart;
+    std::vector<VertexNeighbour> neighbours;
+
+    BoardGeometry(int w, int h);
+};
+
+#endif // GEOMETRY_H
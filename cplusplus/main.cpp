@@ -1,4 +1,11 @@
 #include "solver.h"
+#include "batch.h"
+#include "verify.h"
+#include "dimacs.h"
+#include "schedule.h"
+#include "checkpoint.h"
+#include "portfolio.h"
+#include "valuemodel.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -7,7 +14,9 @@
 #include <chrono>
 #include <algorithm>
 #include <map>
+#include <memory>
 #include <cstring>
+#include <filesystem>
 
 struct Puzzle {
     std::string name;
@@ -91,6 +100,190 @@ std::vector<Puzzle*> loadPuzzles(const std::string& filepath) {
     return puzzles;
 }
 
+// forEachRecord streams the records of filepath that pass filter, offset
+// and numPuzzles to visit. Returns false if the file cannot be opened.
+template <typename Visit>
+bool forEachRecord(const std::string& filepath, const std::string& filter, int offset, int numPuzzles,
+                   Visit visit) {
+    std::ifstream file(filepath);
+    if (!file.is_open()) {
+        std::cerr << "Error opening file: " << filepath << std::endl;
+        return false;
+    }
+    int seen = 0;
+    int visited = 0;
+    std::string line;
+    while (std::getline(file, line)) {
+        std::unique_ptr<Puzzle> puzzle(parsePuzzleLine(line));
+        if (!puzzle) {
+            continue;
+        }
+        if (!filter.empty() && puzzle->name.find(filter) == std::string::npos) {
+            continue;
+        }
+        if (++seen < offset) {
+            continue;
+        }
+        if (numPuzzles > 0 && visited >= numPuzzles) {
+            break;
+        }
+        visited++;
+        visit(*puzzle);
+    }
+    return true;
+}
+
+// runVerify streams the records of filepath and checks each stored answer
+// against its givens without solving. Failing records are always listed;
+// with verbose, valid ones are too. Returns 1 if any record failed.
+int runVerify(const std::string& filepath, const std::string& filter, int offset, int numPuzzles,
+              bool requireUnique, bool verbose) {
+    AnswerVerifier verifier;
+    std::map<std::string, int> failures;
+    int checked = 0;
+    int valid = 0;
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    bool opened = forEachRecord(filepath, filter, offset, numPuzzles, [&](const Puzzle& puzzle) {
+        checked++;
+        AnswerStatus status =
+            verifier.check(puzzle.givens, puzzle.width, puzzle.height, puzzle.answer, requireUnique);
+        if (status == AnswerStatus::VALID) {
+            valid++;
+        } else {
+            failures[answerStatusName(status)]++;
+        }
+        if (verbose || status != AnswerStatus::VALID) {
+            std::cout << puzzle.name << "\t" << answerStatusName(status) << "\n";
+        }
+    });
+    if (!opened) {
+        return 1;
+    }
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    double elapsedTime = std::chrono::duration<double>(endTime - startTime).count();
+
+    std::cout.precision(3);
+    std::cout << "# Verify: " << valid << "/" << checked << " valid";
+    for (const auto& [name, count] : failures) {
+        std::cout << ", " << name << "=" << count;
+    }
+    std::cout << ", time=" << elapsedTime << "s\n";
+    return failures.empty() ? 0 : 1;
+}
+
+// runDimacs writes <dir>/<name>.cnf for every selected record
+int runDimacs(const std::string& filepath, const std::string& filter, int offset, int numPuzzles,
+              const std::string& dir, bool acyclic) {
+    int written = 0;
+    int failed = 0;
+    bool opened = forEachRecord(filepath, filter, offset, numPuzzles, [&](const Puzzle& puzzle) {
+        std::string path = dir + "/" + puzzle.name + ".cnf";
+        std::ofstream out(path);
+        if (!out.is_open() || !ExportCnf(puzzle.givens, puzzle.width, puzzle.height, acyclic, out)) {
+            std::cerr << "Could not write " << path << std::endl;
+            failed++;
+            return;
+        }
+        written++;
+    });
+    std::cout << "# Dimacs: " << written << " written to " << dir;
+    if (failed > 0) {
+        std::cout << ", failed=" << failed;
+    }
+    std::cout << "\n";
+    return (opened && failed == 0) ? 0 : 1;
+}
+
+// runModel reads <dir>/<name>.model for every selected record, applies it
+// to the propagated board and prints a testsuite line with its status
+int runModel(const std::string& filepath, const std::string& filter, int offset, int numPuzzles,
+             const std::string& dir) {
+    std::map<std::string, int> counts;
+    int checked = 0;
+    bool opened = forEachRecord(filepath, filter, offset, numPuzzles, [&](const Puzzle& puzzle) {
+        checked++;
+        std::ifstream model(dir + "/" + puzzle.name + ".model");
+        SolveResult result = model.is_open()
+                                 ? ImportModel(puzzle.givens, puzzle.width, puzzle.height, model)
+                                 : SolveResult{"no_model", "", 0, 0};
+        counts[result.status]++;
+        bool isSolved = (result.status == "solved");
+        std::cout << puzzle.name << "\t" << puzzle.width << "\t" << puzzle.height << "\t" << puzzle.givens
+                  << "\t" << (isSolved ? result.solutionString : "") << "\t# model=" << result.status << "\n";
+    });
+    std::cout << "# Model: " << counts["solved"] << "/" << checked << " solved";
+    for (const auto& [name, count] : counts) {
+        if (name != "solved") {
+            std::cout << ", " << name << "=" << count;
+        }
+    }
+    std::cout << "\n";
+    return (opened && counts["solved"] == checked) ? 0 : 1;
+}
+
+// makeRunKey describes a run for its checkpoint: the input (with its size
+// and modification time, so a regenerated corpus is refused), the record
+// selection, the output mode and every option that changes results or work
+// scores. Options left at their defaults are omitted, as are -batch and -j,
+// which only change how the same results are computed. Add new scoring
+// options here.
+std::string makeRunKey(const std::string& inputFile, const std::string& filter, int offset, int numPuzzles,
+                       const std::string& solver, bool verbose, bool debug, const SolveOptions& options,
+                       const std::string& valueModelPath, bool answerHint) {
+    std::error_code ec;
+    auto size = std::filesystem::file_size(inputFile, ec);
+    auto mtime = std::filesystem::last_write_time(inputFile, ec);
+    std::string key = inputFile + " -size " + std::to_string(ec ? 0 : size) + " -mtime " +
+                      std::to_string(ec ? 0 : (long long)mtime.time_since_epoch().count()) + " -s " + solver + " -mt " + std::to_string(options.maxTier) + " -f " + filter +
+                      " -ofst " + std::to_string(offset) + " -n " + std::to_string(numPuzzles);
+    if (verbose) {
+        key += " -v";
+    }
+    if (debug) {
+        key += " -d";
+    }
+    if (solver == "PF") {
+        key += " -pf " + options.portfolio;
+        if (options.portfolioFirst) {
+            key += " -pf-first";
+        }
+    }
+    if (options.largeBoard) {
+        key += " -large";
+    }
+    if (options.propagationThreads > 1) {
+        key += " -pt " + std::to_string(options.propagationThreads);
+    }
+    if (options.twoSat) {
+        key += " -2sat";
+    }
+    if (options.touchCounting) {
+        key += " -count";
+    }
+    if (options.fullRulesDepth >= 0) {
+        key += " -full-depth " + std::to_string(options.fullRulesDepth);
+    }
+    if (options.probeDepth >= 0) {
+        key += " -probe-depth " + std::to_string(options.probeDepth);
+    }
+    if (!valueModelPath.empty()) {
+        key += " -vm " + valueModelPath;
+    }
+    if (answerHint) {
+        key += " -hint";
+    }
+    if (options.componentCache > 0) {
+        key += " -cc " + std::to_string(options.componentCache);
+    }
+    if (options.symmetryBreaking) {
+        key += " -sym";
+    }
+    return key;
+}
+
 void printUsage(const char* progname) {
     std::cerr << "Usage: " << progname << " [options] <input_file>\n";
     std::cerr << "Options:\n";
@@ -99,9 +292,31 @@ void printUsage(const char* progname) {
     std::cerr << "  -f <filter>   Filter puzzles by partial name match\n";
     std::cerr << "  -n <count>    Maximum number of puzzles to test (0 = all)\n";
     std::cerr << "  -ofst <num>   Puzzle number to start at (1-based, default: 1)\n";
-    std::cerr << "  -s <solver>   Solver to use: PR (production rules) or BF (brute force, default)\n";
+    std::cerr << "  -s <solver>   Solver to use: PR (production rules), BF (brute force, default) or PF (portfolio)\n";
+    std::cerr << "  -pf <engines> With -s PF, engines to race, exhaustive reference first (default BF,BF2SAT,PR)\n";
+    std::cerr << "  -pf-first     With -s PF, report the first definitive engine and its own scores\n";
     std::cerr << "  -mt <tier>    Maximum rule tier to use (1, 2, or 3). Default 10 uses all rules\n";
     std::cerr << "  -ou           Output list of unsolved puzzles (sorted by size)\n";
+    std::cerr << "  -large        Large-board mode: worklist propagation ahead of the rules\n";
+    std::cerr << "  -pt <threads> Parallel large-board propagation with this many threads\n";
+    std::cerr << "  -full-depth <d> BF nodes deeper than d use only the tier 1 rules\n";
+    std::cerr << "  -probe-depth <d> BF nodes up to depth d also probe both values of every cell\n";
+    std::cerr << "  -vm <file>    BF orders branches by a value model from train_value_model.py\n";
+    std::cerr << "  -cc <entries> BF splits into independent components, caching this many results\n";
+    std::cerr << "  -sym          BF searches one solution per symmetry of the clues\n";
+    std::cerr << "  -hint         BF takes each record's answer as a hint and refutes the alternatives\n";
+    std::cerr << "  -count        Enable the touch_counting rule (clue sums along rows and columns)\n";
+    std::cerr << "  -2sat         Solve the binary constraints as 2-SAT once the rules stall\n";
+    std::cerr << "  -batch        Propagate same-sized puzzles together in bit-sliced batches\n";
+    std::cerr << "  -j <threads>  Solve puzzles in parallel, predicted most expensive first\n";
+    std::cerr << "  -ckpt <file>  Save progress to <file> (results to <file>.out) as the run goes\n";
+    std::cerr << "  -ckpt-every <n> Records between checkpoints (default 1000)\n";
+    std::cerr << "  -resume       With -ckpt, continue from the saved checkpoint\n";
+    std::cerr << "  -verify       Check the stored answers instead of solving\n";
+    std::cerr << "  -unique       With -verify, also check that each answer is the only solution\n";
+    std::cerr << "  -dimacs <dir> Write each puzzle, propagated to tier 2, as <dir>/<name>.cnf\n";
+    std::cerr << "  -acyclic      With -dimacs, add the complete acyclicity encoding\n";
+    std::cerr << "  -model <dir>  Read SAT models from <dir>/<name>.model and check them\n";
 }
 
 int main(int argc, char* argv[]) {
@@ -112,8 +327,30 @@ int main(int argc, char* argv[]) {
     int numPuzzles = 0;
     int offset = 1;
     std::string solver = "BF";
+    std::string portfolio = SolveOptions().portfolio;
+    bool portfolioFirst = false;
     int maxTier = 10;
     bool outputUnsolved = false;
+    bool largeBoard = false;
+    int propagationThreads = 1;
+    bool twoSat = false;
+    bool touchCounting = false;
+    int fullRulesDepth = -1;
+    int probeDepth = -1;
+    std::string valueModelPath;
+    bool answerHint = false;
+    int componentCache = 0;
+    bool symmetryBreaking = false;
+    bool batch = false;
+    int solveThreads = 1;
+    std::string checkpointPath;
+    int checkpointEvery = 1000;
+    bool resume = false;
+    bool verify = false;
+    bool requireUnique = false;
+    std::string dimacsDir;
+    bool acyclic = false;
+    std::string modelDir;
     std::string inputFile;
 
     for (int i = 1; i < argc; i++) {
@@ -130,10 +367,54 @@ int main(int argc, char* argv[]) {
             offset = std::stoi(argv[++i]);
         } else if (arg == "-s" && i + 1 < argc) {
             solver = argv[++i];
+        } else if (arg == "-pf" && i + 1 < argc) {
+            portfolio = argv[++i];
+        } else if (arg == "-pf-first") {
+            portfolioFirst = true;
         } else if (arg == "-mt" && i + 1 < argc) {
             maxTier = std::stoi(argv[++i]);
         } else if (arg == "-ou") {
             outputUnsolved = true;
+        } else if (arg == "-large") {
+            largeBoard = true;
+        } else if (arg == "-pt" && i + 1 < argc) {
+            propagationThreads = std::stoi(argv[++i]);
+        } else if (arg == "-full-depth" && i + 1 < argc) {
+            fullRulesDepth = std::stoi(argv[++i]);
+        } else if (arg == "-probe-depth" && i + 1 < argc) {
+            probeDepth = std::stoi(argv[++i]);
+        } else if (arg == "-vm" && i + 1 < argc) {
+            valueModelPath = argv[++i];
+        } else if (arg == "-cc" && i + 1 < argc) {
+            componentCache = std::stoi(argv[++i]);
+        } else if (arg == "-sym") {
+            symmetryBreaking = true;
+        } else if (arg == "-hint") {
+            answerHint = true;
+        } else if (arg == "-count") {
+            touchCounting = true;
+        } else if (arg == "-2sat") {
+            twoSat = true;
+        } else if (arg == "-batch") {
+            batch = true;
+        } else if (arg == "-j" && i + 1 < argc) {
+            solveThreads = std::stoi(argv[++i]);
+        } else if (arg == "-ckpt" && i + 1 < argc) {
+            checkpointPath = argv[++i];
+        } else if (arg == "-ckpt-every" && i + 1 < argc) {
+            checkpointEvery = std::stoi(argv[++i]);
+        } else if (arg == "-resume") {
+            resume = true;
+        } else if (arg == "-verify") {
+            verify = true;
+        } else if (arg == "-unique") {
+            requireUnique = true;
+        } else if (arg == "-dimacs" && i + 1 < argc) {
+            dimacsDir = argv[++i];
+        } else if (arg == "-acyclic") {
+            acyclic = true;
+        } else if (arg == "-model" && i + 1 < argc) {
+            modelDir = argv[++i];
         } else if (arg[0] != '-') {
             inputFile = arg;
         } else {
@@ -148,6 +429,49 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
+    if (resume && checkpointPath.empty()) {
+        std::cerr << "-resume needs -ckpt <file>" << std::endl;
+        return 1;
+    }
+
+    if (solver == "PF") {
+        std::string error;
+        if (!ValidPortfolio(portfolio, error)) {
+            std::cerr << "-pf: " << error << std::endl;
+            return 1;
+        }
+        if (batch) {
+            std::cerr << "-batch cannot be combined with -s PF" << std::endl;
+            return 1;
+        }
+    }
+    if (answerHint && batch) {
+        std::cerr << "-batch cannot be combined with -hint" << std::endl;
+        return 1;
+    }
+    if (componentCache > 0) {
+        // The component search runs in place of the BF loop these refine
+        std::vector<std::pair<bool, const char*>> conflicts = {
+            {answerHint, "-hint"}, {symmetryBreaking, "-sym"}, {!valueModelPath.empty(), "-vm"},
+            {fullRulesDepth >= 0, "-full-depth"}, {probeDepth >= 0, "-probe-depth"}};
+        for (const auto& [given, flag] : conflicts) {
+            if (given) {
+                std::cerr << "-cc cannot be combined with " << flag << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    if (verify) {
+        return runVerify(inputFile, filter, offset, numPuzzles, requireUnique, verbose);
+    }
+    if (!dimacsDir.empty()) {
+        return runDimacs(inputFile, filter, offset, numPuzzles, dimacsDir, acyclic);
+    }
+    if (!modelDir.empty()) {
+        return runModel(inputFile, filter, offset, numPuzzles, modelDir);
+    }
+
     // Load puzzles
     auto puzzles = loadPuzzles(inputFile);
     if (puzzles.empty()) {
@@ -194,7 +518,28 @@ int main(int argc, char* argv[]) {
     }
 
     // Select solve function
-    auto solveFn = (solver == "PR") ? SolvePR : SolveBF;
+    auto solveFn = (solver == "PR") ? SolvePR : (solver == "PF") ? SolvePortfolio : SolveBF;
+    SolveOptions options;
+    options.maxTier = maxTier;
+    options.largeBoard = largeBoard;
+    options.propagationThreads = propagationThreads;
+    options.twoSat = twoSat;
+    options.touchCounting = touchCounting;
+    options.portfolio = portfolio;
+    options.portfolioFirst = portfolioFirst;
+    options.fullRulesDepth = fullRulesDepth;
+    options.probeDepth = probeDepth;
+    options.componentCache = componentCache;
+    options.symmetryBreaking = symmetryBreaking;
+    ValueModel valueModel;
+    if (!valueModelPath.empty()) {
+        std::string error;
+        if (!valueModel.load(valueModelPath, error)) {
+            std::cerr << "-vm: " << error << std::endl;
+            return 1;
+        }
+        options.valueModel = &valueModel;
+    }
 
     // Solve puzzles
     int totalPuzzles = (int)puzzles.size();
@@ -202,91 +547,223 @@ int main(int argc, char* argv[]) {
     int unsolvedCount = 0;
     int multCount = 0;
     int totalWorkScore = 0;
-    std::vector<Puzzle*> unsolvedPuzzles;
+    std::vector<int> unsolvedRecords;
     int totalUnsolvedSquares = 0;
     std::map<int, int> tierCounts = {{1, 0}, {2, 0}, {3, 0}};
-
-    auto startTime = std::chrono::high_resolution_clock::now();
-
-    for (int i = 0; i < (int)puzzles.size(); i++) {
-        Puzzle* puzzle = puzzles[i];
-        int puzzleNum = startIdx + i + 1;
-
-        if (debug) {
-            std::cout << "\n" << std::string(60, '=') << "\n";
-            std::cout << "Puzzle " << puzzleNum << ": " << puzzle->name
-                      << " (" << puzzle->width << "x" << puzzle->height << ")\n";
-            std::cout << "Givens: " << puzzle->givens << "\n";
-            std::cout << std::string(60, '=') << "\n";
+    double previousElapsed = 0;
+    int firstRecord = 0;
+
+    // With a checkpoint, per-puzzle output goes to <checkpoint>.out and is
+    // copied to stdout once the run is complete
+    std::string runKey = makeRunKey(inputFile, filter, offset, numPuzzles, solver, verbose, debug, options,
+                                   valueModelPath, answerHint);
+    std::string resultPath = checkpointPath + ".out";
+    std::ofstream resultFile;
+    if (!checkpointPath.empty()) {
+        Checkpoint saved;
+        if (resume) {
+            // A mistyped path must not truncate the finished output
+            if (!std::ifstream(checkpointPath).is_open()) {
+                std::cerr << "Cannot resume: no checkpoint at " << checkpointPath
+                          << " (run without -resume to start over)" << std::endl;
+                return 1;
+            }
+            if (!saved.load(checkpointPath)) {
+                std::cerr << "Malformed checkpoint: " << checkpointPath << std::endl;
+                return 1;
+            }
+            if (saved.runKey != runKey) {
+                std::cerr << "Checkpoint " << checkpointPath << " is for a different run: " << saved.runKey
+                          << std::endl;
+                return 1;
+            }
+            firstRecord = std::min(saved.completed, totalPuzzles);
+            solvedCount = saved.solvedCount;
+            unsolvedCount = saved.unsolvedCount;
+            multCount = saved.multCount;
+            totalWorkScore = saved.totalWorkScore;
+            totalUnsolvedSquares = saved.totalUnsolvedSquares;
+            for (int tier = 1; tier <= 3; tier++) {
+                tierCounts[tier] = saved.tierCounts[tier];
+            }
+            previousElapsed = saved.elapsedTime;
+            unsolvedRecords = saved.unsolvedRecords;
+        }
+        // Drop output written after the last checkpoint; it is regenerated
+        std::error_code ec;
+        if (firstRecord > 0) {
+            std::filesystem::resize_file(resultPath, saved.outputBytes, ec);
+        }
+        resultFile.open(resultPath, firstRecord > 0 ? std::ios::app : std::ios::trunc);
+        if (ec || !resultFile.is_open()) {
+            std::cerr << "Cannot write " << resultPath << std::endl;
+            return 1;
         }
+    }
+    std::ostream& out = resultFile.is_open() ? static_cast<std::ostream&>(resultFile) : std::cout;
 
-        SolveResult result = solveFn(puzzle->givens, puzzle->width, puzzle->height, maxTier);
+    auto startTime = std::chrono::high_resolution_clock::now();
 
-        // Count unsolved squares
-        int unsolvedSquares = 0;
-        for (char c : result.solutionString) {
-            if (c == '.') unsolvedSquares++;
+    // With a checkpoint, puzzles are solved in chunks of checkpointEvery with
+    // a checkpoint after each chunk; otherwise the whole run is one chunk
+    int chunkSize = checkpointPath.empty() ? std::max(1, totalPuzzles) : std::max(1, checkpointEvery);
+    for (int chunkStart = firstRecord; chunkStart < totalPuzzles; chunkStart += chunkSize) {
+        int chunkEnd = std::min(totalPuzzles, chunkStart + chunkSize);
+
+        // In batch mode, runs of consecutive same-sized puzzles are solved up front;
+        // with -j, the whole chunk is solved up front on a thread pool
+        std::vector<SolveResult> presolved;
+        if (batch) {
+            int i = chunkStart;
+            while (i < chunkEnd) {
+                std::vector<std::string> givens;
+                int j = i;
+                while (j < chunkEnd && puzzles[j]->width == puzzles[i]->width &&
+                       puzzles[j]->height == puzzles[i]->height) {
+                    givens.push_back(puzzles[j]->givens);
+                    j++;
+                }
+                auto results = SolveBatch(givens, puzzles[i]->width, puzzles[i]->height, solveFn, options);
+                presolved.insert(presolved.end(), results.begin(), results.end());
+                i = j;
+            }
+        } else if (solveThreads > 1) {
+            std::vector<SolveJob> jobs;
+            for (int i = chunkStart; i < chunkEnd; i++) {
+                jobs.push_back({puzzles[i]->givens, puzzles[i]->width, puzzles[i]->height,
+                                answerHint ? puzzles[i]->answer : ""});
+            }
+            presolved = SolveParallel(jobs, solveThreads, solveFn, options);
         }
-        totalUnsolvedSquares += unsolvedSquares;
 
-        bool isSolved = (result.status == "solved");
-        bool isMult = (result.status == "mult");
+        for (int i = chunkStart; i < chunkEnd; i++) {
+            Puzzle* puzzle = puzzles[i];
+            int puzzleNum = startIdx + i + 1;
 
-        if (isSolved) {
-            solvedCount++;
-            totalWorkScore += result.workScore;
-            if (tierCounts.find(result.maxTierUsed) != tierCounts.end()) {
-                tierCounts[result.maxTierUsed]++;
+            if (debug) {
+                out << "\n" << std::string(60, '=') << "\n";
+                out << "Puzzle " << puzzleNum << ": " << puzzle->name
+                          << " (" << puzzle->width << "x" << puzzle->height << ")\n";
+                out << "Givens: " << puzzle->givens << "\n";
+                out << std::string(60, '=') << "\n";
             }
 
-            if (debug && !puzzle->answer.empty() && result.solutionString != puzzle->answer) {
-                std::cout << "NOTE: Solution differs from expected answer\n";
-                std::cout << "  Got:      " << result.solutionString << "\n";
-                std::cout << "  Expected: " << puzzle->answer << "\n";
+            SolveResult result;
+            if (!presolved.empty()) {
+                result = presolved[i - chunkStart];
+            } else if (answerHint) {
+                SolveOptions hinted = options;
+                hinted.answerHint = puzzle->answer;
+                result = solveFn(puzzle->givens, puzzle->width, puzzle->height, hinted);
+            } else {
+                result = solveFn(puzzle->givens, puzzle->width, puzzle->height, options);
             }
-        } else if (isMult) {
-            multCount++;
-            unsolvedPuzzles.push_back(puzzle);
-        } else {
-            unsolvedCount++;
-            unsolvedPuzzles.push_back(puzzle);
-        }
 
-        if (debug) {
-            std::string statusUpper = result.status;
-            for (auto& c : statusUpper) c = toupper(c);
-            std::cout << "\nStatus: " << statusUpper << ", Work score: " << result.workScore << "\n";
-            if (unsolvedSquares > 0) {
-                std::cout << "Unsolved cells: " << unsolvedSquares << "\n";
+            // Count unsolved squares
+            int unsolvedSquares = 0;
+            for (char c : result.solutionString) {
+                if (c == '.') unsolvedSquares++;
             }
-        }
+            totalUnsolvedSquares += unsolvedSquares;
+
+            bool isSolved = (result.status == "solved");
+            bool isMult = (result.status == "mult");
 
-        if (verbose) {
-            std::string solutionStr = isSolved ? result.solutionString : "";
-            std::vector<std::string> commentParts;
-            if (!puzzle->comment.empty()) {
-                commentParts.push_back(puzzle->comment);
+            if (isSolved) {
+                solvedCount++;
+                totalWorkScore += result.workScore;
+                if (tierCounts.find(result.maxTierUsed) != tierCounts.end()) {
+                    tierCounts[result.maxTierUsed]++;
+                }
+
+                if (debug && !puzzle->answer.empty() && result.solutionString != puzzle->answer) {
+                    out << "NOTE: Solution differs from expected answer\n";
+                    out << "  Got:      " << result.solutionString << "\n";
+                    out << "  Expected: " << puzzle->answer << "\n";
+                }
+            } else if (isMult) {
+                multCount++;
+                unsolvedRecords.push_back(i);
+            } else {
+                unsolvedCount++;
+                unsolvedRecords.push_back(i);
             }
-            commentParts.push_back("work_score=" + std::to_string(result.workScore));
-            if (!isSolved) {
-                commentParts.push_back("status=" + result.status);
+
+            if (debug) {
+                std::string statusUpper = result.status;
+                for (auto& c : statusUpper) c = toupper(c);
+                out << "\nStatus: " << statusUpper << ", Work score: " << result.workScore << "\n";
                 if (unsolvedSquares > 0) {
-                    commentParts.push_back("unsolved=" + std::to_string(unsolvedSquares));
+                    out << "Unsolved cells: " << unsolvedSquares << "\n";
+                }
+            }
+
+            if (verbose) {
+                std::string solutionStr = isSolved ? result.solutionString : "";
+                std::vector<std::string> commentParts;
+                if (!puzzle->comment.empty()) {
+                    commentParts.push_back(puzzle->comment);
+                }
+                commentParts.push_back("work_score=" + std::to_string(result.workScore));
+                if (!result.engine.empty()) {
+                    commentParts.push_back("engine=" + result.engine);
+                }
+                if (options.valueModel) {
+                    commentParts.push_back("nodes=" + std::to_string(result.searchNodes));
+                    commentParts.push_back("first_solution_nodes=" + std::to_string(result.firstSolutionNodes));
+                }
+                if (!isSolved) {
+                    commentParts.push_back("status=" + result.status);
+                    if (unsolvedSquares > 0) {
+                        commentParts.push_back("unsolved=" + std::to_string(unsolvedSquares));
+                    }
                 }
+                std::string comment;
+                for (size_t j = 0; j < commentParts.size(); j++) {
+                    if (j > 0) comment += " ";
+                    comment += commentParts[j];
+                }
+
+                out << puzzle->name << "\t" << puzzle->width << "\t" << puzzle->height
+                          << "\t" << puzzle->givens << "\t" << solutionStr << "\t# " << comment << "\n";
             }
-            std::string comment;
-            for (size_t j = 0; j < commentParts.size(); j++) {
-                if (j > 0) comment += " ";
-                comment += commentParts[j];
+        }
+
+        if (!checkpointPath.empty()) {
+            out.flush();
+            Checkpoint checkpoint;
+            checkpoint.runKey = runKey;
+            checkpoint.completed = chunkEnd;
+            checkpoint.outputBytes = (long long)resultFile.tellp();
+            checkpoint.solvedCount = solvedCount;
+            checkpoint.unsolvedCount = unsolvedCount;
+            checkpoint.multCount = multCount;
+            checkpoint.totalWorkScore = totalWorkScore;
+            checkpoint.totalUnsolvedSquares = totalUnsolvedSquares;
+            for (int tier = 1; tier <= 3; tier++) {
+                checkpoint.tierCounts[tier] = tierCounts[tier];
+            }
+            checkpoint.elapsedTime = previousElapsed + std::chrono::duration<double>(
+                std::chrono::high_resolution_clock::now() - startTime).count();
+            checkpoint.unsolvedRecords = unsolvedRecords;
+            if (!checkpoint.save(checkpointPath)) {
+                std::cerr << "Cannot write checkpoint " << checkpointPath << std::endl;
+                return 1;
             }
+        }
+    }
 
-            std::cout << puzzle->name << "\t" << puzzle->width << "\t" << puzzle->height
-                      << "\t" << puzzle->givens << "\t" << solutionStr << "\t# " << comment << "\n";
+    if (resultFile.is_open()) {
+        resultFile.close();
+        std::ifstream results(resultPath);
+        // Inserting an empty streambuf would set failbit on std::cout
+        if (results.peek() != std::ifstream::traits_type::eof()) {
+            std::cout << results.rdbuf();
         }
     }
 
     auto endTime = std::chrono::high_resolution_clock::now();
-    double elapsedTime = std::chrono::duration<double>(endTime - startTime).count();
+    double elapsedTime = previousElapsed + std::chrono::duration<double>(endTime - startTime).count();
 
     // Print summary
     double solvedPct = (totalPuzzles > 0) ? (double)solvedCount / totalPuzzles * 100 : 0;
@@ -332,6 +809,10 @@ int main(int argc, char* argv[]) {
     }
 
     // Output unsolved puzzles
+    std::vector<Puzzle*> unsolvedPuzzles;
+    for (int record : unsolvedRecords) {
+        unsolvedPuzzles.push_back(puzzles[record]);
+    }
     if (outputUnsolved && !unsolvedPuzzles.empty()) {
         std::cout << "\nUnsolved puzzles (sorted by size):\n";
 
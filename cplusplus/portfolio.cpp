@@ -0,0 +1,119 @@
+#include "portfolio.h"
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Engine is one configured solver of a portfolio
+struct Engine {
+    std::string name;
+    SolveResult (*solve)(const std::string&, int, int, const SolveOptions&);
+    SolveOptions options;
+    bool exhaustive;  // An unsolved result proves there is no solution
+};
+
+bool makeEngine(const std::string& name, const SolveOptions& base, Engine& engine) {
+    engine = {name, SolveBF, base, true};
+    engine.options.cancel = nullptr;
+    if (name == "PR") {
+        engine.solve = SolvePR;
+        engine.exhaustive = false;
+    } else if (name == "BF2SAT") {
+        engine.options.twoSat = true;
+    } else if (name == "BFCOUNT") {
+        engine.options.touchCounting = true;
+    } else if (name != "BF") {
+        return false;
+    }
+    return true;
+}
+
+std::vector<std::string> splitNames(const std::string& spec) {
+    std::vector<std::string> names;
+    std::stringstream stream(spec);
+    std::string name;
+    while (std::getline(stream, name, ',')) {
+        names.push_back(name);
+    }
+    return names;
+}
+
+}  // namespace
+
+bool ValidPortfolio(const std::string& spec, std::string& error) {
+    auto names = splitNames(spec);
+    if (names.empty()) {
+        error = "empty portfolio";
+        return false;
+    }
+    Engine engine;
+    for (const auto& name : names) {
+        if (!makeEngine(name, SolveOptions(), engine)) {
+            error = "unknown portfolio engine '" + name + "'";
+            return false;
+        }
+        if (name == names[0] && !engine.exhaustive) {
+            error = "the reference engine '" + name + "' (listed first) must be exhaustive: BF, BF2SAT or BFCOUNT";
+            return false;
+        }
+    }
+    return true;
+}
+
+SolveResult SolvePortfolio(const std::string& givensString, int width, int height, const SolveOptions& options) {
+    std::vector<Engine> engines;
+    for (const auto& name : splitNames(options.portfolio)) {
+        Engine engine;
+        if (makeEngine(name, options, engine)) {
+            engines.push_back(engine);
+        }
+    }
+    if (engines.empty()) {
+        return {"unsolved", "", 0, 0};
+    }
+
+    std::atomic<bool> cancel(false);
+    std::mutex mutex;
+    int winner = -1;
+    std::vector<SolveResult> results(engines.size());
+
+    // The reference can only be cancelled when its score is not reported.
+    // The others stop at the first definitive result, or once the reference
+    // is done, since nothing is waiting for them after that.
+    auto runEngine = [&](int i) {
+        Engine& engine = engines[i];
+        if (i > 0 || options.portfolioFirst) {
+            engine.options.cancel = &cancel;
+        }
+        results[i] = engine.solve(givensString, width, height, engine.options);
+        const std::string& status = results[i].status;
+        bool definitive = status == "solved" || status == "mult" || (status == "unsolved" && engine.exhaustive);
+        std::lock_guard<std::mutex> lock(mutex);
+        if (definitive && winner < 0) {
+            winner = i;
+            cancel = true;
+        }
+        if (i == 0) {
+            cancel = true;
+        }
+    };
+
+    // The reference runs on the calling thread
+    std::vector<std::thread> threads;
+    for (int i = 1; i < (int)engines.size(); i++) {
+        threads.emplace_back(runEngine, i);
+    }
+    runEngine(0);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    if (winner < 0) {
+        winner = 0;
+    }
+    SolveResult result = options.portfolioFirst ? results[winner] : results[0];
+    result.engine = engines[winner].name;
+    return result;
+}
@@ -0,0 +1,29 @@
+#ifndef PORTFOLIO_H
+#define PORTFOLIO_H
+
+#include "solver.h"
+#include <string>
+
+// Engine names accepted in SolveOptions::portfolio:
+//   PR       production rules only
+//   BF       brute force with the standard rules
+//   BF2SAT   brute force with the 2-SAT stage
+//   BFCOUNT  brute force with the touch_counting rule
+// Each engine otherwise inherits the caller's options.
+
+// ValidPortfolio reports whether spec is a non-empty comma-separated list
+// of known engine names whose first entry, the reference, is exhaustive
+// (a BF engine); if not, error says why
+bool ValidPortfolio(const std::string& spec, std::string& error);
+
+// SolvePortfolio races the engines listed in options.portfolio on one
+// puzzle, one thread each, and result.engine names the first to reach a
+// definitive status (solved, mult, or unsolved from an exhaustive engine).
+// By default the first engine listed is the reference: the result is its
+// own, with its work score and tier, so grading does not depend on which
+// engine won, and the others are cancelled once it finishes. With
+// options.portfolioFirst the first definitive result is returned at once,
+// with the winning engine's own work score and tier.
+SolveResult SolvePortfolio(const std::string& givensString, int width, int height, const SolveOptions& options);
+
+#endif // PORTFOLIO_H
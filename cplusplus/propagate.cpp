@@ -0,0 +1,469 @@
+#include "propagate.h"
+#include <algorithm>
+#include <thread>
+
+// Below this much queued work a round is evaluated on the calling thread;
+// spawning threads would cost more than it saves.
+constexpr size_t PARALLEL_MIN_WORK = 1024;
+
+// forEachStripe runs fn(stripe) for every stripe, one thread per stripe
+// when parallel is set.
+template <typename Fn>
+static void forEachStripe(int numStripes, bool parallel, Fn fn) {
+    if (!parallel || numStripes == 1) {
+        for (int s = 0; s < numStripes; s++) {
+            fn(s);
+        }
+        return;
+    }
+    std::vector<std::thread> threads;
+    threads.reserve(numStripes - 1);
+    for (int s = 1; s < numStripes; s++) {
+        threads.emplace_back(fn, s);
+    }
+    fn(0);
+    for (auto& t : threads) {
+        t.join();
+    }
+}
+
+// makeStripes splits rows [0, height) into numStripes nearly equal ranges
+// and returns their start rows followed by height.
+static std::vector<int> makeStripes(int height, int numStripes) {
+    std::vector<int> start(numStripes + 1);
+    for (int s = 0; s <= numStripes; s++) {
+        start[s] = (int)((long long)height * s / numStripes);
+    }
+    return start;
+}
+
+LocalPropagator::LocalPropagator(Board* b, int threads)
+    : board(b), seeded(false), contradiction(false), lastUnknown(b->getUnknownCount()),
+      numThreads(std::max(1, threads)) {
+    int numStripes = std::max(1, std::min(numThreads, board->height));
+    stripeStart = makeStripes(board->height, numStripes);
+    stripeOfRow.resize(board->height + 1);
+    for (int s = 0; s < numStripes; s++) {
+        for (int y = stripeStart[s]; y < stripeStart[s + 1]; y++) {
+            stripeOfRow[y] = s;
+        }
+    }
+    stripeOfRow[board->height] = numStripes - 1;
+
+    vertexQueues.resize(numStripes);
+    cellQueues.resize(numStripes);
+    proposals.resize(numStripes);
+    stripeContradiction.resize(numStripes, 0);
+    vertexQueued.resize((board->width + 1) * (board->height + 1), 0);
+    cellQueued.resize(board->width * board->height, 0);
+}
+
+void LocalPropagator::enqueueVertex(Vertex* vertex) {
+    if (!vertex->hasClue) {
+        return;
+    }
+    int idx = vertex->vy * (board->width + 1) + vertex->vx;
+    if (!vertexQueued[idx]) {
+        vertexQueued[idx] = 1;
+        vertexQueues[stripeOfRow[vertex->vy]].push_back(vertex);
+    }
+}
+
+void LocalPropagator::enqueueCell(Cell* cell) {
+    if (cell->value != UNKNOWN) {
+        return;
+    }
+    int idx = cell->y * board->width + cell->x;
+    if (!cellQueued[idx]) {
+        cellQueued[idx] = 1;
+        cellQueues[stripeOfRow[cell->y]].push_back(cell);
+    }
+}
+
+// enqueueAround queues the clued corners of a newly placed cell and the
+// unknown cells sharing a corner with it, whose loop status may have changed.
+void LocalPropagator::enqueueAround(Cell* cell) {
+    int x = cell->x;
+    int y = cell->y;
+    for (int dy = 0; dy <= 1; dy++) {
+        for (int dx = 0; dx <= 1; dx++) {
+            enqueueVertex(board->vertexAt(x + dx, y + dy));
+        }
+    }
+    for (int dy = -1; dy <= 1; dy++) {
+        for (int dx = -1; dx <= 1; dx++) {
+            enqueueCell(board->cellAt(x + dx, y + dy));
+        }
+    }
+}
+
+void LocalPropagator::seedAll() {
+    for (Vertex* vertex : board->getCluedVertices()) {
+        enqueueVertex(vertex);
+    }
+    for (Cell* cell : board->getUnknownCells()) {
+        enqueueCell(cell);
+    }
+    seeded = true;
+}
+
+void LocalPropagator::seedPlacedSinceLastRun() {
+    // Cells placed since the last run sit just past the live part of the
+    // unknown sparse set, in placement order.
+    int numUnknown = board->getUnknownCount();
+    for (int i = numUnknown; i < lastUnknown; i++) {
+        enqueueAround(board->unknownDense[i]);
+    }
+}
+
+// evaluateVertex applies clue_finish_a and clue_finish_b to one clued vertex.
+// It only reads the board and returns false if the clue can no longer be met.
+bool LocalPropagator::evaluateVertex(Vertex* vertex, std::vector<Proposal>& out) {
+    auto [current, unknown] = board->countTouches(vertex);
+    if (current > vertex->clue || current + unknown < vertex->clue) {
+        return false;
+    }
+    if (unknown == 0) {
+        return true;
+    }
+
+    bool touch;
+    if (current == vertex->clue) {
+        touch = false;
+    } else if (vertex->clue - current == unknown) {
+        touch = true;
+    } else {
+        return true;
+    }
+
+    for (auto& adj : board->getAdjacentCellsForVertex(vertex)) {
+        if (adj.cell->value == UNKNOWN) {
+            out.push_back({adj.cell, (adj.slashTouches == touch) ? SLASH : BACKSLASH});
+        }
+    }
+    return true;
+}
+
+// evaluateCell applies no_loops to one unknown cell. It only reads the board
+// and returns false if both values would close a loop.
+bool LocalPropagator::evaluateCell(Cell* cell, std::vector<Proposal>& out) {
+    if (cell->value != UNKNOWN) {
+        return true;
+    }
+    bool slashLoops = board->wouldFormLoopReadOnly(cell, SLASH);
+    bool backslashLoops = board->wouldFormLoopReadOnly(cell, BACKSLASH);
+    if (slashLoops && backslashLoops) {
+        return false;
+    }
+    if (slashLoops) {
+        out.push_back({cell, BACKSLASH});
+    } else if (backslashLoops) {
+        out.push_back({cell, SLASH});
+    }
+    return true;
+}
+
+void LocalPropagator::evaluateStripe(int stripe) {
+    auto& out = proposals[stripe];
+    for (Vertex* vertex : vertexQueues[stripe]) {
+        vertexQueued[vertex->vy * (board->width + 1) + vertex->vx] = 0;
+        if (!evaluateVertex(vertex, out)) {
+            stripeContradiction[stripe] = 1;
+        }
+    }
+    vertexQueues[stripe].clear();
+    for (Cell* cell : cellQueues[stripe]) {
+        cellQueued[cell->y * board->width + cell->x] = 0;
+        if (!evaluateCell(cell, out)) {
+            stripeContradiction[stripe] = 1;
+        }
+    }
+    cellQueues[stripe].clear();
+}
+
+// apply places a proposed value. A proposal that clashes with an earlier
+// placement or closes a loop means the position is contradictory.
+bool LocalPropagator::apply(const Proposal& proposal) {
+    if (proposal.cell->value == proposal.value) {
+        return false;
+    }
+    if (proposal.cell->value != UNKNOWN || board->wouldFormLoop(proposal.cell, proposal.value)) {
+        contradiction = true;
+        return false;
+    }
+    board->placeValue(proposal.cell, proposal.value);
+    enqueueAround(proposal.cell);
+    return true;
+}
+
+bool LocalPropagator::runSerial() {
+    auto& vertexQueue = vertexQueues[0];
+    auto& cellQueue = cellQueues[0];
+    auto& out = proposals[0];
+    bool madeProgress = false;
+
+    while ((!vertexQueue.empty() || !cellQueue.empty()) && !contradiction) {
+        // Drain clue checks first; they are cheaper than loop checks
+        while (!vertexQueue.empty() && !contradiction) {
+            Vertex* vertex = vertexQueue.back();
+            vertexQueue.pop_back();
+            vertexQueued[vertex->vy * (board->width + 1) + vertex->vx] = 0;
+            if (!evaluateVertex(vertex, out)) {
+                contradiction = true;
+            }
+            for (const auto& p : out) {
+                if (apply(p)) {
+                    madeProgress = true;
+                }
+            }
+            out.clear();
+        }
+        if (!cellQueue.empty() && !contradiction) {
+            Cell* cell = cellQueue.back();
+            cellQueue.pop_back();
+            cellQueued[cell->y * board->width + cell->x] = 0;
+            if (!evaluateCell(cell, out)) {
+                contradiction = true;
+            }
+            for (const auto& p : out) {
+                if (apply(p)) {
+                    madeProgress = true;
+                }
+            }
+            out.clear();
+        }
+    }
+    return madeProgress;
+}
+
+bool LocalPropagator::runStriped() {
+    int numStripes = (int)vertexQueues.size();
+    bool madeProgress = false;
+
+    while (!contradiction) {
+        size_t pending = 0;
+        for (int s = 0; s < numStripes; s++) {
+            pending += vertexQueues[s].size() + cellQueues[s].size();
+        }
+        if (pending == 0) {
+            break;
+        }
+
+        forEachStripe(numStripes, pending >= PARALLEL_MIN_WORK,
+                      [this](int s) { evaluateStripe(s); });
+        for (int s = 0; s < numStripes; s++) {
+            if (stripeContradiction[s]) {
+                contradiction = true;
+            }
+        }
+
+        // Apply in stripe order so the result does not depend on timing
+        for (int s = 0; s < numStripes; s++) {
+            for (const auto& p : proposals[s]) {
+                if (!contradiction && apply(p)) {
+                    madeProgress = true;
+                }
+            }
+            proposals[s].clear();
+        }
+    }
+    return madeProgress;
+}
+
+bool LocalPropagator::drain() {
+    return (vertexQueues.size() > 1) ? runStriped() : runSerial();
+}
+
+bool LocalPropagator::run() {
+    if (contradiction) {
+        return false;
+    }
+    if (!seeded) {
+        seedAll();
+    } else {
+        seedPlacedSinceLastRun();
+    }
+
+    bool madeProgress = drain();
+
+    // A placement can force a loop avoidance far from the cells queued
+    // around it. Sweeping every unknown cell once the queues drain makes the
+    // fixpoint, and whether a contradiction is found, independent of
+    // evaluation order.
+    while (!contradiction) {
+        for (Cell* cell : board->getUnknownCells()) {
+            enqueueCell(cell);
+        }
+        if (!drain()) {
+            break;
+        }
+        madeProgress = true;
+    }
+
+    lastUnknown = board->getUnknownCount();
+    return madeProgress;
+}
+
+bool ruleVBitmapPropagationStriped(Board* board, int numThreads) {
+    int w = board->width;
+    int h = board->height;
+    int numStripes = std::max(1, std::min(numThreads, h));
+    std::vector<int> start = makeStripes(h, numStripes);
+    bool parallel = numStripes > 1 && (size_t)w * h >= PARALLEL_MIN_WORK;
+
+    std::vector<uint8_t> vbitmap(w * h);
+
+    // Constraints from known cells and 1/3 clues do not change while the
+    // rule runs, so each cell pulls them from its neighbours once.
+    forEachStripe(numStripes, parallel, [&](int s) {
+        for (int y = start[s]; y < start[s + 1]; y++) {
+            for (int x = 0; x < w; x++) {
+                int bits = 0xF;
+                int value = board->cellAt(x, y)->value;
+                int right = board->cellAt(x + 1, y)->value;
+                int below = board->cellAt(x, y + 1)->value;
+                if (value == SLASH) bits &= ~0x5;
+                if (value == BACKSLASH) bits &= ~0xA;
+                if (right == SLASH) bits &= ~0x2;
+                if (right == BACKSLASH) bits &= ~0x1;
+                if (below == SLASH) bits &= ~0x8;
+                if (below == BACKSLASH) bits &= ~0x4;
+
+                // This cell is the top-left, bottom-left and top-right cell
+                // of three interior vertices
+                if (x + 1 < w && y + 1 < h) {
+                    int c = board->vertexAt(x + 1, y + 1)->clue;
+                    if (c == 1) bits &= ~0x5;
+                    if (c == 3) bits &= ~0xA;
+                }
+                if (x + 1 < w && y >= 1) {
+                    int c = board->vertexAt(x + 1, y)->clue;
+                    if (c == 1) bits &= ~0x2;
+                    if (c == 3) bits &= ~0x1;
+                }
+                if (x >= 1 && y + 1 < h) {
+                    int c = board->vertexAt(x, y + 1)->clue;
+                    if (c == 1) bits &= ~0x8;
+                    if (c == 3) bits &= ~0x4;
+                }
+                vbitmap[y * w + x] = (uint8_t)bits;
+            }
+        }
+    });
+
+    // Interior 2 clues couple their top-left cell with the cells below and
+    // to the right. A clue belongs to the stripe owning its top row; its
+    // bottom-left cell may be the first row of the next stripe, which the
+    // stripe reads from a ghost copy and updates through a message queue.
+    std::vector<std::vector<Vertex*>> twos(numStripes);
+    for (Vertex* vertex : board->getCluedVertices(2)) {
+        if (vertex->vx >= 1 && vertex->vx < w && vertex->vy >= 1 && vertex->vy < h) {
+            int row = vertex->vy - 1;
+            int s = (int)(std::upper_bound(start.begin(), start.end(), row) - start.begin()) - 1;
+            twos[s].push_back(vertex);
+        }
+    }
+
+    std::vector<std::vector<uint8_t>> ghost(numStripes, std::vector<uint8_t>(w));
+    std::vector<std::vector<std::pair<int, uint8_t>>> outbox(numStripes);
+    std::vector<uint8_t> topRowChanged(numStripes);
+
+    bool again = true;
+    while (again) {
+        for (int s = 0; s + 1 < numStripes; s++) {
+            std::copy(vbitmap.begin() + start[s + 1] * w, vbitmap.begin() + (start[s + 1] + 1) * w,
+                      ghost[s].begin());
+        }
+
+        forEachStripe(numStripes, parallel, [&](int s) {
+            int y0 = start[s];
+            int y1 = start[s + 1];
+            std::vector<uint8_t> before = ghost[s];
+            topRowChanged[s] = 0;
+
+            auto at = [&](int x, int y) -> uint8_t& {
+                return (y < y1) ? vbitmap[y * w + x] : ghost[s][x];
+            };
+
+            bool changed = true;
+            while (changed) {
+                changed = false;
+                for (Vertex* vertex : twos[s]) {
+                    int vx = vertex->vx;
+                    int vy = vertex->vy;
+                    uint8_t& tl = at(vx - 1, vy - 1);
+                    uint8_t& bl = at(vx - 1, vy);
+                    uint8_t& tr = at(vx, vy - 1);
+                    uint8_t oldTL = tl, oldBL = bl, oldTR = tr;
+
+                    int top = tl & 0x3;
+                    int bot = bl & 0x3;
+                    tl &= ~(0x3 ^ bot);
+                    bl &= ~(0x3 ^ top);
+                    int left = tl & 0xC;
+                    int right = tr & 0xC;
+                    tl &= ~(0xC ^ right);
+                    tr &= ~(0xC ^ left);
+
+                    if (tl != oldTL || bl != oldBL || tr != oldTR) {
+                        changed = true;
+                        if (vy - 1 == y0 && (tl != oldTL || tr != oldTR)) {
+                            topRowChanged[s] = 1;
+                        }
+                    }
+                }
+            }
+
+            outbox[s].clear();
+            if (s + 1 < numStripes) {
+                for (int x = 0; x < w; x++) {
+                    if (ghost[s][x] != before[x]) {
+                        outbox[s].push_back({x, ghost[s][x]});
+                    }
+                }
+            }
+        });
+
+        // Deliver boundary updates; a stripe whose top row changed also
+        // invalidates the ghost row of the stripe above it
+        again = false;
+        for (int s = 0; s < numStripes; s++) {
+            if (s > 0 && topRowChanged[s]) {
+                again = true;
+            }
+            for (const auto& [x, bits] : outbox[s]) {
+                uint8_t& cell = vbitmap[start[s + 1] * w + x];
+                if ((cell & bits) != cell) {
+                    cell &= bits;
+                    again = true;
+                }
+            }
+        }
+    }
+
+    // Cells with no possible v-shape across an edge are equivalent
+    std::vector<std::vector<std::pair<Cell*, Cell*>>> pairs(numStripes);
+    forEachStripe(numStripes, parallel, [&](int s) {
+        for (int y = start[s]; y < start[s + 1]; y++) {
+            for (int x = 0; x < w; x++) {
+                Cell* cell = board->cellAt(x, y);
+                if (x + 1 < w && (vbitmap[y * w + x] & 0x3) == 0) {
+                    pairs[s].push_back({cell, board->cellAt(x + 1, y)});
+                }
+                if (y + 1 < h && (vbitmap[y * w + x] & 0xC) == 0) {
+                    pairs[s].push_back({cell, board->cellAt(x, y + 1)});
+                }
+            }
+        }
+    });
+
+    bool madeProgress = false;
+    for (int s = 0; s < numStripes; s++) {
+        for (const auto& [a, b] : pairs[s]) {
+            if (board->markCellsEquivalent(a, b)) {
+                madeProgress = true;
+            }
+        }
+    }
+    return madeProgress;
+}
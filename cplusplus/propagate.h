@@ -0,0 +1,78 @@
+#ifndef PROPAGATE_H
+#define PROPAGATE_H
+
+#include "board.h"
+#include <vector>
+
+// LocalPropagator runs the clue-completion and loop-avoidance deductions
+// from a worklist instead of sweeping the whole board. After the first run
+// it only revisits clued vertices and cells around cells placed since the
+// previous run, plus one loop-avoidance sweep over the unknown cells once
+// the worklists drain, so a run costs time linear in the number of
+// placements and unknown cells rather than board size times rule firings.
+//
+// Cells placed by other rules between runs are picked up from the tail of
+// the board's unknown-cell sparse set. The propagator must not be reused
+// across restoreState calls; create a new one instead.
+//
+// With numThreads > 1 the board is split into horizontal stripes, each with
+// its own worklists. Every round evaluates all queued work concurrently
+// against the unchanged board, then applies the resulting placements (and
+// their union-find merges) in one batch on the calling thread, routing the
+// follow-up work to the stripes that own it. The deductions are monotone,
+// so this reaches the same fixpoint as the serial propagator.
+class LocalPropagator {
+public:
+    explicit LocalPropagator(Board* board, int numThreads = 1);
+
+    // run propagates to a local fixpoint and returns true if any cell was placed
+    bool run();
+
+    // hasContradiction reports whether propagation proved the position has no
+    // solution. Once set, run does nothing.
+    bool hasContradiction() const { return contradiction; }
+
+private:
+    struct Proposal {
+        Cell* cell;
+        int value;
+    };
+
+    Board* board;
+    bool seeded;
+    bool contradiction;
+    int lastUnknown;
+    int numThreads;
+
+    // Stripe s owns cell rows [stripeStart[s], stripeStart[s + 1]) and the
+    // vertex rows with the same numbers (the last stripe also owns the
+    // bottom vertex row).
+    std::vector<int> stripeStart;
+    std::vector<int> stripeOfRow;
+    std::vector<std::vector<Vertex*>> vertexQueues;
+    std::vector<std::vector<Cell*>> cellQueues;
+    std::vector<std::vector<Proposal>> proposals;
+    std::vector<uint8_t> stripeContradiction;
+    std::vector<uint8_t> vertexQueued;
+    std::vector<uint8_t> cellQueued;
+
+    void seedAll();
+    void seedPlacedSinceLastRun();
+    void enqueueVertex(Vertex* vertex);
+    void enqueueCell(Cell* cell);
+    void enqueueAround(Cell* cell);
+    bool evaluateVertex(Vertex* vertex, std::vector<Proposal>& out);
+    bool evaluateCell(Cell* cell, std::vector<Proposal>& out);
+    void evaluateStripe(int stripe);
+    bool apply(const Proposal& proposal);
+    bool runSerial();
+    bool runStriped();
+    bool drain();
+};
+
+// ruleVBitmapPropagationStriped computes the same v-bitmap fixpoint and
+// equivalences as ruleVBitmapPropagation, with the board split into
+// horizontal stripes processed by numThreads threads.
+bool ruleVBitmapPropagationStriped(Board* board, int numThreads);
+
+#endif // PROPAGATE_H
@@ -1,6 +1,4 @@
 #include "rules.h"
-#include <map>
-#include <set>
 #include <cmath>
 
 std::vector<Rule> getRules() {
@@ -21,6 +19,10 @@ std::vector<Rule> getRules() {
     };
 }
 
+Rule getTouchCountingRule() {
+    return {"touch_counting", 7, 2, ruleTouchCounting};
+}
+
 // ruleClueFinishA: If a clue needs all remaining unknowns to touch, fill them.
 bool ruleClueFinishA(Board* board) {
     bool madeProgress = false;
@@ -30,7 +32,7 @@ bool ruleClueFinishA(Board* board) {
         int clue = vertex->clue;
 
         int currentTouches = 0;
-        std::vector<AdjacentCellInfo> unknownCells;
+        AdjacentList unknownCells;
 
         for (auto& adj : adjacent) {
             if (adj.cell->value == UNKNOWN) {
@@ -74,7 +76,7 @@ bool ruleClueFinishB(Board* board) {
         int clue = vertex->clue;
 
         int currentTouches = 0;
-        std::vector<AdjacentCellInfo> unknownCells;
+        AdjacentList unknownCells;
 
         for (auto& adj : adjacent) {
             if (adj.cell->value == UNKNOWN) {
@@ -170,11 +172,7 @@ bool ruleEdgeClueConstraints(Board* board) {
 bool ruleBorderTwoVShape(Board* board) {
     bool madeProgress = false;
 
-    for (Vertex* vertex : board->getCluedVertices()) {
-        if (vertex->clue != 2) {
-            continue;
-        }
-
+    for (Vertex* vertex : board->getCluedVertices(2)) {
         auto adjacent = board->getAdjacentCellsForVertex(vertex);
         if (adjacent.size() != 2) {
             continue;
@@ -204,18 +202,18 @@ bool ruleBorderTwoVShape(Board* board) {
     return madeProgress;
 }
 
-// ruleLoopAvoidance2: Detect when finishing a 2 would force a loop.
+// ruleLoopAvoidance2: If finishing a 2 one way would close a loop, it must
+// be finished another way. Every way of completing the 2 from its unknown
+// cells is checked against the vertex union-find roots of the cell corners;
+// a cell that takes the same value in every completion without a loop is
+// placed.
 bool ruleLoopAvoidance2(Board* board) {
     bool madeProgress = false;
 
-    for (Vertex* vertex : board->getCluedVertices()) {
-        if (vertex->clue != 2) {
-            continue;
-        }
-
+    for (Vertex* vertex : board->getCluedVertices(2)) {
         auto adjacent = board->getAdjacentCellsForVertex(vertex);
         int currentTouches = 0;
-        std::vector<AdjacentCellInfo> unknownCells;
+        AdjacentList unknownCells;
 
         for (auto& adj : adjacent) {
             if (adj.cell->value == UNKNOWN) {
@@ -227,36 +225,83 @@ bool ruleLoopAvoidance2(Board* board) {
             }
         }
 
-        if (currentTouches != 0 || unknownCells.size() != 2) {
+        int needed = 2 - currentTouches;
+        int numUnknown = unknownCells.size();
+        if (numUnknown < 2 || needed < 1 || needed > numUnknown) {
             continue;
         }
 
-        // Both unknowns must touch
-        Cell* cell1 = unknownCells[0].cell;
-        bool slash1 = unknownCells[0].slashTouches;
-        Cell* cell2 = unknownCells[1].cell;
-        bool slash2 = unknownCells[1].slashTouches;
-
-        int val1 = slash1 ? SLASH : BACKSLASH;
-        int val2 = slash2 ? SLASH : BACKSLASH;
-
-        // Save state and try
-        auto state = board->saveState();
-
-        if (board->wouldFormLoop(cell1, val1)) {
-            board->restoreState(state);
-            continue;
+        // Roots of both diagonals' endpoints for each unknown cell
+        int ends[4][2][2];
+        for (int i = 0; i < numUnknown; i++) {
+            Cell* cell = unknownCells[i].cell;
+            int x = cell->x;
+            int y = cell->y;
+            ends[i][0][0] = board->getVertexRoot(x, y + 1);      // slash
+            ends[i][0][1] = board->getVertexRoot(x + 1, y);
+            ends[i][1][0] = board->getVertexRoot(x, y);          // backslash
+            ends[i][1][1] = board->getVertexRoot(x + 1, y + 1);
         }
 
-        board->placeValue(cell1, val1);
+        // Bit i of a completion is set if cell i touches the 2
+        int possible[4] = {0, 0, 0, 0};
+        for (int touching = 0; touching < (1 << numUnknown); touching++) {
+            if (__builtin_popcount(touching) != needed) {
+                continue;
+            }
+            int values[4];
+            for (int i = 0; i < numUnknown; i++) {
+                bool touches = (touching >> i) & 1;
+                values[i] = (touches == unknownCells[i].slashTouches) ? SLASH : BACKSLASH;
+            }
 
-        if (board->wouldFormLoop(cell2, val2)) {
-            // Would form loop - contradiction
-            board->restoreState(state);
-            continue;
+            // Join the new diagonals in a small union-find over the roots
+            int roots[8];
+            int up[8];
+            int numRoots = 0;
+            auto slot = [&](int root) {
+                for (int k = 0; k < numRoots; k++) {
+                    if (roots[k] == root) {
+                        return k;
+                    }
+                }
+                roots[numRoots] = root;
+                up[numRoots] = numRoots;
+                return numRoots++;
+            };
+            auto find = [&](int k) {
+                while (up[k] != k) {
+                    k = up[k];
+                }
+                return k;
+            };
+            bool loop = false;
+            for (int i = 0; i < numUnknown && !loop; i++) {
+                int a = find(slot(ends[i][values[i] - 1][0]));
+                int b = find(slot(ends[i][values[i] - 1][1]));
+                if (a == b) {
+                    loop = true;
+                } else {
+                    up[a] = b;
+                }
+            }
+            if (loop) {
+                continue;
+            }
+            for (int i = 0; i < numUnknown; i++) {
+                possible[i] |= 1 << values[i];
+            }
         }
 
-        board->restoreState(state);
+        // With no completion left the board is invalid, which BF detects
+        for (int i = 0; i < numUnknown; i++) {
+            Cell* cell = unknownCells[i].cell;
+            int value = (possible[i] == (1 << SLASH)) ? SLASH : (possible[i] == (1 << BACKSLASH)) ? BACKSLASH : 0;
+            if (value && cell->value == UNKNOWN && !board->wouldFormLoop(cell, value)) {
+                board->placeValue(cell, value);
+                madeProgress = true;
+            }
+        }
     }
 
     return madeProgress;
@@ -268,17 +313,13 @@ bool ruleVPatternWithThree(Board* board) {
 
     for (int y = 0; y < board->height; y++) {
         for (int x = 0; x < board->width - 1; x++) {
-            Cell* cellLeft = board->getCell(x, y);
-            Cell* cellRight = board->getCell(x + 1, y);
-
-            if (!cellLeft || !cellRight) {
-                continue;
-            }
+            Cell* cellLeft = board->cellAt(x, y);
+            Cell* cellRight = board->cellAt(x + 1, y);
 
             // Check for \/ pattern (V pointing down)
             if (cellLeft->value == BACKSLASH && cellRight->value == SLASH) {
-                Vertex* vertexAbove = board->getVertex(x + 1, y);
-                if (vertexAbove && vertexAbove->hasClue && vertexAbove->clue == 3) {
+                Vertex* vertexAbove = board->vertexAt(x + 1, y);
+                if (vertexAbove->hasClue && vertexAbove->clue == 3) {
                     auto [current, unknown] = board->countTouches(vertexAbove);
                     if (current == 2 && unknown > 0) {
                         for (auto& adj : board->getAdjacentCellsForVertex(vertexAbove)) {
@@ -303,8 +344,8 @@ bool ruleVPatternWithThree(Board* board) {
 
             // Check for /\ pattern (V pointing up)
             if (cellLeft->value == SLASH && cellRight->value == BACKSLASH) {
-                Vertex* vertexBelow = board->getVertex(x + 1, y + 1);
-                if (vertexBelow && vertexBelow->hasClue && vertexBelow->clue == 3) {
+                Vertex* vertexBelow = board->vertexAt(x + 1, y + 1);
+                if (vertexBelow->hasClue && vertexBelow->clue == 3) {
                     auto [current, unknown] = board->countTouches(vertexBelow);
                     if (current == 2 && unknown > 0) {
                         for (auto& adj : board->getAdjacentCellsForVertex(vertexBelow)) {
@@ -336,11 +377,7 @@ bool ruleVPatternWithThree(Board* board) {
 bool ruleAdjacentOnes(Board* board) {
     bool madeProgress = false;
 
-    for (Vertex* vertex : board->getCluedVertices()) {
-        if (vertex->clue != 1) {
-            continue;
-        }
-
+    for (Vertex* vertex : board->getCluedVertices(1)) {
         int vx = vertex->vx;
         int vy = vertex->vy;
         auto [current, _] = board->countTouches(vertex);
@@ -349,22 +386,22 @@ bool ruleAdjacentOnes(Board* board) {
             // Check adjacent 1s and mark shared cells as avoiders
             int directions[][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
             for (auto& dir : directions) {
-                Vertex* neighbor = board->getVertex(vx + dir[0], vy + dir[1]);
-                if (!neighbor || !neighbor->hasClue || neighbor->clue != 1) {
+                Vertex* neighbor = board->vertexAt(vx + dir[0], vy + dir[1]);
+                if (!neighbor->hasClue || neighbor->clue != 1) {
                     continue;
                 }
 
                 auto neighborAdj = board->getAdjacentCellsForVertex(neighbor);
-                std::set<Cell*> neighborCells;
+                InlineList<Cell*, 4> neighborCells;
                 for (auto& n : neighborAdj) {
-                    neighborCells.insert(n.cell);
+                    neighborCells.push_back(n.cell);
                 }
 
                 for (auto& adj : board->getAdjacentCellsForVertex(vertex)) {
                     if (adj.cell->value != UNKNOWN) {
                         continue;
                     }
-                    if (neighborCells.count(adj.cell)) {
+                    if (neighborCells.contains(adj.cell)) {
                         // Shared cell - must avoid this vertex
                         if (adj.slashTouches) {
                             if (!board->wouldFormLoop(adj.cell, BACKSLASH)) {
@@ -390,39 +427,35 @@ bool ruleAdjacentOnes(Board* board) {
 bool ruleAdjacentThrees(Board* board) {
     bool madeProgress = false;
 
-    for (Vertex* vertex : board->getCluedVertices()) {
-        if (vertex->clue != 3) {
-            continue;
-        }
-
+    for (Vertex* vertex : board->getCluedVertices(3)) {
         int vx = vertex->vx;
         int vy = vertex->vy;
         auto [current, _] = board->countTouches(vertex);
 
         int directions[][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
         for (auto& dir : directions) {
-            Vertex* neighbor = board->getVertex(vx + dir[0], vy + dir[1]);
-            if (!neighbor || !neighbor->hasClue || neighbor->clue != 3) {
+            Vertex* neighbor = board->vertexAt(vx + dir[0], vy + dir[1]);
+            if (!neighbor->hasClue || neighbor->clue != 3) {
                 continue;
             }
 
             auto myAdj = board->getAdjacentCellsForVertex(vertex);
             auto neighborAdj = board->getAdjacentCellsForVertex(neighbor);
-            std::set<Cell*> neighborCells;
+            InlineList<Cell*, 4> neighborCells;
             for (auto& n : neighborAdj) {
-                neighborCells.insert(n.cell);
+                neighborCells.push_back(n.cell);
             }
 
-            std::vector<AdjacentCellInfo> sharedCells, unsharedCells;
+            AdjacentList sharedCells, unsharedCells;
             for (auto& adj : myAdj) {
-                if (neighborCells.count(adj.cell)) {
+                if (neighborCells.contains(adj.cell)) {
                     sharedCells.push_back(adj);
                 } else {
                     unsharedCells.push_back(adj);
                 }
             }
 
-            std::vector<AdjacentCellInfo> unsharedUnknown;
+            AdjacentList unsharedUnknown;
             for (auto& adj : unsharedCells) {
                 if (adj.cell->value == UNKNOWN) {
                     unsharedUnknown.push_back(adj);
@@ -507,7 +540,7 @@ bool ruleEquivalenceClasses(Board* board) {
     for (Vertex* vertex : board->getCluedVertices()) {
         auto adjacent = board->getAdjacentCellsForVertex(vertex);
         int currentTouches = 0;
-        std::vector<AdjacentCellInfo> unknownCells;
+        AdjacentList unknownCells;
 
         for (auto& adj : adjacent) {
             if (adj.cell->value == UNKNOWN) {
@@ -564,8 +597,10 @@ bool ruleVBitmapPropagation(Board* board) {
     int w = board->width;
     int h = board->height;
 
-    // Local vbitmap for this iteration
-    std::vector<std::vector<int>> vbitmap(h, std::vector<int>(w, 0xF));
+    // Local vbitmap for this call, in the board's reusable scratch grid
+    EpochGrid<uint8_t>& grid = board->scratch.vshapes;
+    grid.reset(w * h, 0xF);
+    auto vbitmap = [&grid, w](int y, int x) -> uint8_t& { return grid[y * w + x]; };
 
     bool changed = true;
     while (changed) {
@@ -574,98 +609,97 @@ bool ruleVBitmapPropagation(Board* board) {
         // Apply constraints from known cell values
         for (int y = 0; y < h; y++) {
             for (int x = 0; x < w; x++) {
-                Cell* cell = board->getCell(x, y);
+                Cell* cell = board->cellAt(x, y);
                 if (cell->value == UNKNOWN) {
                     continue;
                 }
                 int s = cell->value;
-                int old = vbitmap[y][x];
+                int old = vbitmap(y, x);
                 if (s == SLASH) {
-                    vbitmap[y][x] &= ~0x5;
-                    if (x > 0 && (vbitmap[y][x - 1] & 0x2)) {
-                        vbitmap[y][x - 1] &= ~0x2;
+                    vbitmap(y, x) &= ~0x5;
+                    if (x > 0 && (vbitmap(y, x - 1) & 0x2)) {
+                        vbitmap(y, x - 1) &= ~0x2;
                         changed = true;
                     }
-                    if (y > 0 && (vbitmap[y - 1][x] & 0x8)) {
-                        vbitmap[y - 1][x] &= ~0x8;
+                    if (y > 0 && (vbitmap(y - 1, x) & 0x8)) {
+                        vbitmap(y - 1, x) &= ~0x8;
                         changed = true;
                     }
                 } else {
-                    vbitmap[y][x] &= ~0xA;
-                    if (x > 0 && (vbitmap[y][x - 1] & 0x1)) {
-                        vbitmap[y][x - 1] &= ~0x1;
+                    vbitmap(y, x) &= ~0xA;
+                    if (x > 0 && (vbitmap(y, x - 1) & 0x1)) {
+                        vbitmap(y, x - 1) &= ~0x1;
                         changed = true;
                     }
-                    if (y > 0 && (vbitmap[y - 1][x] & 0x4)) {
-                        vbitmap[y - 1][x] &= ~0x4;
+                    if (y > 0 && (vbitmap(y - 1, x) & 0x4)) {
+                        vbitmap(y - 1, x) &= ~0x4;
                         changed = true;
                     }
                 }
-                if (vbitmap[y][x] != old) {
+                if (vbitmap(y, x) != old) {
                     changed = true;
                 }
             }
         }
 
-        // Apply constraints from clues
-        for (int vy = 1; vy < h; vy++) {
-            for (int vx = 1; vx < w; vx++) {
-                Vertex* vertex = board->getVertex(vx, vy);
-                if (!vertex || !vertex->hasClue) {
-                    continue;
+        // Apply constraints from interior clues
+        for (Vertex* vertex : board->getCluedVertices()) {
+            int vx = vertex->vx;
+            int vy = vertex->vy;
+            if (vx < 1 || vx >= w || vy < 1 || vy >= h) {
+                continue;
+            }
+            int c = vertex->clue;
+
+            if (c == 1) {
+                int old1 = vbitmap(vy - 1, vx - 1);
+                int old2 = vbitmap(vy, vx - 1);
+                int old3 = vbitmap(vy - 1, vx);
+                vbitmap(vy - 1, vx - 1) &= ~0x5;
+                if (vy < h) {
+                    vbitmap(vy, vx - 1) &= ~0x2;
+                }
+                if (vx < w) {
+                    vbitmap(vy - 1, vx) &= ~0x8;
+                }
+                if (vbitmap(vy - 1, vx - 1) != old1 || vbitmap(vy, vx - 1) != old2 || vbitmap(vy - 1, vx) != old3) {
+                    changed = true;
+                }
+            } else if (c == 3) {
+                int old1 = vbitmap(vy - 1, vx - 1);
+                int old2 = vbitmap(vy, vx - 1);
+                int old3 = vbitmap(vy - 1, vx);
+                vbitmap(vy - 1, vx - 1) &= ~0xA;
+                if (vy < h) {
+                    vbitmap(vy, vx - 1) &= ~0x1;
+                }
+                if (vx < w) {
+                    vbitmap(vy - 1, vx) &= ~0x4;
+                }
+                if (vbitmap(vy - 1, vx - 1) != old1 || vbitmap(vy, vx - 1) != old2 || vbitmap(vy - 1, vx) != old3) {
+                    changed = true;
+                }
+            } else if (c == 2) {
+                int oldTL = vbitmap(vy - 1, vx - 1);
+                int oldBL = vbitmap(vy, vx - 1);
+                int oldTR = vbitmap(vy - 1, vx);
+
+                if (vy < h) {
+                    int top = vbitmap(vy - 1, vx - 1) & 0x3;
+                    int bot = vbitmap(vy, vx - 1) & 0x3;
+                    vbitmap(vy - 1, vx - 1) &= ~(0x3 ^ bot);
+                    vbitmap(vy, vx - 1) &= ~(0x3 ^ top);
                 }
-                int c = vertex->clue;
-
-                if (c == 1) {
-                    int old1 = vbitmap[vy - 1][vx - 1];
-                    int old2 = vbitmap[vy][vx - 1];
-                    int old3 = vbitmap[vy - 1][vx];
-                    vbitmap[vy - 1][vx - 1] &= ~0x5;
-                    if (vy < h) {
-                        vbitmap[vy][vx - 1] &= ~0x2;
-                    }
-                    if (vx < w) {
-                        vbitmap[vy - 1][vx] &= ~0x8;
-                    }
-                    if (vbitmap[vy - 1][vx - 1] != old1 || vbitmap[vy][vx - 1] != old2 || vbitmap[vy - 1][vx] != old3) {
-                        changed = true;
-                    }
-                } else if (c == 3) {
-                    int old1 = vbitmap[vy - 1][vx - 1];
-                    int old2 = vbitmap[vy][vx - 1];
-                    int old3 = vbitmap[vy - 1][vx];
-                    vbitmap[vy - 1][vx - 1] &= ~0xA;
-                    if (vy < h) {
-                        vbitmap[vy][vx - 1] &= ~0x1;
-                    }
-                    if (vx < w) {
-                        vbitmap[vy - 1][vx] &= ~0x4;
-                    }
-                    if (vbitmap[vy - 1][vx - 1] != old1 || vbitmap[vy][vx - 1] != old2 || vbitmap[vy - 1][vx] != old3) {
-                        changed = true;
-                    }
-                } else if (c == 2) {
-                    int oldTL = vbitmap[vy - 1][vx - 1];
-                    int oldBL = vbitmap[vy][vx - 1];
-                    int oldTR = vbitmap[vy - 1][vx];
-
-                    if (vy < h) {
-                        int top = vbitmap[vy - 1][vx - 1] & 0x3;
-                        int bot = vbitmap[vy][vx - 1] & 0x3;
-                        vbitmap[vy - 1][vx - 1] &= ~(0x3 ^ bot);
-                        vbitmap[vy][vx - 1] &= ~(0x3 ^ top);
-                    }
 
-                    if (vx < w) {
-                        int left = vbitmap[vy - 1][vx - 1] & 0xC;
-                        int right = vbitmap[vy - 1][vx] & 0xC;
-                        vbitmap[vy - 1][vx - 1] &= ~(0xC ^ right);
-                        vbitmap[vy - 1][vx] &= ~(0xC ^ left);
-                    }
+                if (vx < w) {
+                    int left = vbitmap(vy - 1, vx - 1) & 0xC;
+                    int right = vbitmap(vy - 1, vx) & 0xC;
+                    vbitmap(vy - 1, vx - 1) &= ~(0xC ^ right);
+                    vbitmap(vy - 1, vx) &= ~(0xC ^ left);
+                }
 
-                    if (vbitmap[vy - 1][vx - 1] != oldTL || vbitmap[vy][vx - 1] != oldBL || vbitmap[vy - 1][vx] != oldTR) {
-                        changed = true;
-                    }
+                if (vbitmap(vy - 1, vx - 1) != oldTL || vbitmap(vy, vx - 1) != oldBL || vbitmap(vy - 1, vx) != oldTR) {
+                    changed = true;
                 }
             }
         }
@@ -673,11 +707,11 @@ bool ruleVBitmapPropagation(Board* board) {
         // Mark equivalent cells
         for (int y = 0; y < h; y++) {
             for (int x = 0; x < w; x++) {
-                Cell* cell = board->getCell(x, y);
+                Cell* cell = board->cellAt(x, y);
 
                 if (x + 1 < w) {
-                    Cell* rightCell = board->getCell(x + 1, y);
-                    if ((vbitmap[y][x] & 0x3) == 0) {
+                    Cell* rightCell = board->cellAt(x + 1, y);
+                    if ((vbitmap(y, x) & 0x3) == 0) {
                         if (board->markCellsEquivalent(cell, rightCell)) {
                             madeProgress = true;
                             changed = true;
@@ -686,8 +720,8 @@ bool ruleVBitmapPropagation(Board* board) {
                 }
 
                 if (y + 1 < h) {
-                    Cell* belowCell = board->getCell(x, y + 1);
-                    if ((vbitmap[y][x] & 0xC) == 0) {
+                    Cell* belowCell = board->cellAt(x, y + 1);
+                    if ((vbitmap(y, x) & 0xC) == 0) {
                         if (board->markCellsEquivalent(cell, belowCell)) {
                             madeProgress = true;
                             changed = true;
@@ -714,123 +748,115 @@ bool ruleSimonUnified(Board* board) {
         doneSomething = false;
 
         // Phase 1: Clue completion with equivalence tracking
-        for (int vy = 0; vy < H; vy++) {
-            for (int vx = 0; vx < W; vx++) {
-                Vertex* vertex = board->getVertex(vx, vy);
-                if (!vertex || !vertex->hasClue) {
-                    continue;
-                }
-
-                int c = vertex->clue;
-
-                // Build list of neighbors
-                struct NeighborInfo {
-                    Cell* cell;
-                    int slashType;
-                };
-                std::vector<NeighborInfo> neighbours;
-
-                if (vx > 0 && vy > 0) {
-                    Cell* cell = board->getCell(vx - 1, vy - 1);
-                    neighbours.push_back({cell, BACKSLASH});
-                }
-                if (vx > 0 && vy < h) {
-                    Cell* cell = board->getCell(vx - 1, vy);
-                    neighbours.push_back({cell, SLASH});
-                }
-                if (vx < w && vy < h) {
-                    Cell* cell = board->getCell(vx, vy);
-                    neighbours.push_back({cell, BACKSLASH});
-                }
-                if (vx < w && vy > 0) {
-                    Cell* cell = board->getCell(vx, vy - 1);
-                    neighbours.push_back({cell, SLASH});
+        for (Vertex* vertex : board->getCluedVertices()) {
+            int vx = vertex->vx;
+            int vy = vertex->vy;
+
+            int c = vertex->clue;
+
+            // Build list of neighbors
+            struct NeighborInfo {
+                Cell* cell;
+                int slashType;
+            };
+            InlineList<NeighborInfo, 4> neighbours;
+
+            // Around the vertex from top-left; sentinel cells off the board are skipped
+            const NeighborInfo around[] = {
+                {board->cellAt(vx - 1, vy - 1), BACKSLASH},
+                {board->cellAt(vx - 1, vy), SLASH},
+                {board->cellAt(vx, vy), BACKSLASH},
+                {board->cellAt(vx, vy - 1), SLASH},
+            };
+            for (const auto& n : around) {
+                if (n.cell->value != OUTSIDE) {
+                    neighbours.push_back(n);
                 }
+            }
 
-                if (neighbours.empty()) {
-                    continue;
-                }
+            if (neighbours.empty()) {
+                continue;
+            }
 
-                int nneighbours = (int)neighbours.size();
-                int nu = 0;
-                int nl = c;
+            int nneighbours = (int)neighbours.size();
+            int nu = 0;
+            int nl = c;
 
-                Cell* lastCell = neighbours[nneighbours - 1].cell;
-                int lastEq = -1;
-                if (lastCell->value == UNKNOWN) {
-                    lastEq = board->getCellEquivRoot(lastCell);
-                }
+            Cell* lastCell = neighbours[nneighbours - 1].cell;
+            int lastEq = -1;
+            if (lastCell->value == UNKNOWN) {
+                lastEq = board->getCellEquivRoot(lastCell);
+            }
 
-                int meq = -1;
-                Cell* mj1 = nullptr;
-                Cell* mj2 = nullptr;
+            int meq = -1;
+            Cell* mj1 = nullptr;
+            Cell* mj2 = nullptr;
 
-                for (int i = 0; i < nneighbours; i++) {
-                    Cell* cell = neighbours[i].cell;
-                    int slashType = neighbours[i].slashType;
-                    if (cell->value == UNKNOWN) {
-                        nu++;
-                        if (meq < 0) {
-                            int eq = board->getCellEquivRoot(cell);
-                            if (eq == lastEq && lastCell != cell) {
-                                meq = eq;
-                                mj1 = lastCell;
-                                mj2 = cell;
-                                nl--;
-                                nu -= 2;
-                            } else {
-                                lastEq = eq;
-                            }
-                        }
-                    } else {
-                        lastEq = -1;
-                        if (cell->value == slashType) {
+            for (int i = 0; i < nneighbours; i++) {
+                Cell* cell = neighbours[i].cell;
+                int slashType = neighbours[i].slashType;
+                if (cell->value == UNKNOWN) {
+                    nu++;
+                    if (meq < 0) {
+                        int eq = board->getCellEquivRoot(cell);
+                        if (eq == lastEq && lastCell != cell) {
+                            meq = eq;
+                            mj1 = lastCell;
+                            mj2 = cell;
                             nl--;
+                            nu -= 2;
+                        } else {
+                            lastEq = eq;
                         }
                     }
-                    lastCell = cell;
+                } else {
+                    lastEq = -1;
+                    if (cell->value == slashType) {
+                        nl--;
+                    }
                 }
+                lastCell = cell;
+            }
 
-                if (nl < 0 || nl > nu) {
-                    continue;
-                }
+            if (nl < 0 || nl > nu) {
+                continue;
+            }
 
-                if (nu > 0 && (nl == 0 || nl == nu)) {
-                    for (auto& n : neighbours) {
-                        if (n.cell == mj1 || n.cell == mj2) {
-                            continue;
+            if (nu > 0 && (nl == 0 || nl == nu)) {
+                for (auto& n : neighbours) {
+                    if (n.cell == mj1 || n.cell == mj2) {
+                        continue;
+                    }
+                    if (n.cell->value == UNKNOWN) {
+                        int value;
+                        if (nl > 0) {
+                            value = n.slashType;
+                        } else {
+                            value = (n.slashType == SLASH) ? BACKSLASH : SLASH;
                         }
-                        if (n.cell->value == UNKNOWN) {
-                            int value;
-                            if (nl > 0) {
-                                value = n.slashType;
-                            } else {
-                                value = (n.slashType == SLASH) ? BACKSLASH : SLASH;
-                            }
 
-                            if (!board->wouldFormLoop(n.cell, value)) {
-                                board->placeValue(n.cell, value);
-                                doneSomething = true;
-                                madeProgress = true;
-                            }
+                        if (!board->wouldFormLoop(n.cell, value)) {
+                            board->placeValue(n.cell, value);
+                            doneSomething = true;
+                            madeProgress = true;
                         }
                     }
-                } else if (nu == 2 && nl == 1) {
-                    int lastIdx = -1;
-                    for (int i = 0; i < nneighbours; i++) {
-                        Cell* cell = neighbours[i].cell;
-                        if (cell->value == UNKNOWN && cell != mj1 && cell != mj2) {
-                            if (lastIdx < 0) {
-                                lastIdx = i;
-                            } else if (lastIdx == i - 1 || (lastIdx == 0 && i == nneighbours - 1)) {
-                                Cell* cell1 = neighbours[lastIdx].cell;
-                                Cell* cell2 = neighbours[i].cell;
-                                if (board->markCellsEquivalent(cell1, cell2)) {
-                                    doneSomething = true;
-                                    madeProgress = true;
-                                }
-                                break;
+                }
+            } else if (nu == 2 && nl == 1) {
+                int lastIdx = -1;
+                for (int i = 0; i < nneighbours; i++) {
+                    Cell* cell = neighbours[i].cell;
+                    if (cell->value == UNKNOWN && cell != mj1 && cell != mj2) {
+                        if (lastIdx < 0) {
+                            lastIdx = i;
+                        } else if (lastIdx == i - 1 || (lastIdx == 0 && i == nneighbours - 1)) {
+                            Cell* cell1 = neighbours[lastIdx].cell;
+                            Cell* cell2 = neighbours[i].cell;
+                            if (board->markCellsEquivalent(cell1, cell2)) {
+                                doneSomething = true;
+                                madeProgress = true;
                             }
+                            break;
                         }
                     }
                 }
@@ -844,7 +870,7 @@ bool ruleSimonUnified(Board* board) {
         // Phase 2: Loop avoidance, dead-end avoidance, equivalence filling
         for (int y = 0; y < h; y++) {
             for (int x = 0; x < w; x++) {
-                Cell* cell = board->getCell(x, y);
+                Cell* cell = board->cellAt(x, y);
                 if (cell->value != UNKNOWN) {
                     continue;
                 }
@@ -916,12 +942,12 @@ bool ruleSimonUnified(Board* board) {
         // Phase 3: V-bitmap propagation
         for (int y = 0; y < h; y++) {
             for (int x = 0; x < w; x++) {
-                Cell* cell = board->getCell(x, y);
+                Cell* cell = board->cellAt(x, y);
                 int s = cell->value;
 
                 if (s != UNKNOWN) {
                     if (x > 0) {
-                        Cell* leftCell = board->getCell(x - 1, y);
+                        Cell* leftCell = board->cellAt(x - 1, y);
                         int bits = (s == SLASH) ? 0x2 : 0x1;
                         if (board->vbitmapClear(leftCell, bits)) {
                             doneSomething = true;
@@ -938,7 +964,7 @@ bool ruleSimonUnified(Board* board) {
                     }
 
                     if (y > 0) {
-                        Cell* aboveCell = board->getCell(x, y - 1);
+                        Cell* aboveCell = board->cellAt(x, y - 1);
                         int bits = (s == SLASH) ? 0x8 : 0x4;
                         if (board->vbitmapClear(aboveCell, bits)) {
                             doneSomething = true;
@@ -956,7 +982,7 @@ bool ruleSimonUnified(Board* board) {
                 }
 
                 if (x + 1 < w && (board->vbitmapGet(cell) & 0x3) == 0) {
-                    Cell* rightCell = board->getCell(x + 1, y);
+                    Cell* rightCell = board->cellAt(x + 1, y);
                     if (board->markCellsEquivalent(cell, rightCell)) {
                         doneSomething = true;
                         madeProgress = true;
@@ -964,7 +990,7 @@ bool ruleSimonUnified(Board* board) {
                 }
 
                 if (y + 1 < h && (board->vbitmapGet(cell) & 0xC) == 0) {
-                    Cell* belowCell = board->getCell(x, y + 1);
+                    Cell* belowCell = board->cellAt(x, y + 1);
                     if (board->markCellsEquivalent(cell, belowCell)) {
                         doneSomething = true;
                         madeProgress = true;
@@ -974,69 +1000,161 @@ bool ruleSimonUnified(Board* board) {
         }
 
         // V-bitmap constraints from interior clues
-        for (int vy = 1; vy < H - 1; vy++) {
-            for (int vx = 1; vx < W - 1; vx++) {
-                Vertex* vertex = board->getVertex(vx, vy);
-                if (!vertex || !vertex->hasClue) {
-                    continue;
+        for (Vertex* vertex : board->getCluedVertices()) {
+            int vx = vertex->vx;
+            int vy = vertex->vy;
+            if (vx < 1 || vx >= W - 1 || vy < 1 || vy >= H - 1) {
+                continue;
+            }
+
+            int c = vertex->clue;
+            Cell* tl = board->cellAt(vx - 1, vy - 1);
+            Cell* bl = board->cellAt(vx - 1, vy);
+            Cell* tr = board->cellAt(vx, vy - 1);
+
+            if (c == 1) {
+                if (board->vbitmapClear(tl, 0x5)) {
+                    doneSomething = true;
+                    madeProgress = true;
+                }
+                if (board->vbitmapClear(bl, 0x2)) {
+                    doneSomething = true;
+                    madeProgress = true;
+                }
+                if (board->vbitmapClear(tr, 0x8)) {
+                    doneSomething = true;
+                    madeProgress = true;
+                }
+            } else if (c == 3) {
+                if (board->vbitmapClear(tl, 0xA)) {
+                    doneSomething = true;
+                    madeProgress = true;
+                }
+                if (board->vbitmapClear(bl, 0x1)) {
+                    doneSomething = true;
+                    madeProgress = true;
+                }
+                if (board->vbitmapClear(tr, 0x4)) {
+                    doneSomething = true;
+                    madeProgress = true;
+                }
+            } else if (c == 2) {
+                int tlH = board->vbitmapGet(tl) & 0x3;
+                int blH = board->vbitmapGet(bl) & 0x3;
+                if (board->vbitmapClear(tl, 0x3 ^ blH)) {
+                    doneSomething = true;
+                    madeProgress = true;
+                }
+                if (board->vbitmapClear(bl, 0x3 ^ tlH)) {
+                    doneSomething = true;
+                    madeProgress = true;
                 }
 
-                int c = vertex->clue;
-                Cell* tl = board->getCell(vx - 1, vy - 1);
-                Cell* bl = board->getCell(vx - 1, vy);
-                Cell* tr = board->getCell(vx, vy - 1);
+                int tlV = board->vbitmapGet(tl) & 0xC;
+                int trV = board->vbitmapGet(tr) & 0xC;
+                if (board->vbitmapClear(tl, 0xC ^ trV)) {
+                    doneSomething = true;
+                    madeProgress = true;
+                }
+                if (board->vbitmapClear(tr, 0xC ^ tlV)) {
+                    doneSomething = true;
+                    madeProgress = true;
+                }
+            }
+        }
+    }
 
-                if (c == 1) {
-                    if (board->vbitmapClear(tl, 0x5)) {
-                        doneSomething = true;
-                        madeProgress = true;
-                    }
-                    if (board->vbitmapClear(bl, 0x2)) {
-                        doneSomething = true;
-                        madeProgress = true;
-                    }
-                    if (board->vbitmapClear(tr, 0x8)) {
-                        doneSomething = true;
-                        madeProgress = true;
-                    }
-                } else if (c == 3) {
-                    if (board->vbitmapClear(tl, 0xA)) {
-                        doneSomething = true;
-                        madeProgress = true;
-                    }
-                    if (board->vbitmapClear(bl, 0x1)) {
-                        doneSomething = true;
-                        madeProgress = true;
-                    }
-                    if (board->vbitmapClear(tr, 0x4)) {
-                        doneSomething = true;
-                        madeProgress = true;
-                    }
-                } else if (c == 2) {
-                    int tlH = board->vbitmapGet(tl) & 0x3;
-                    int blH = board->vbitmapGet(bl) & 0x3;
-                    if (board->vbitmapClear(tl, 0x3 ^ blH)) {
-                        doneSomething = true;
-                        madeProgress = true;
-                    }
-                    if (board->vbitmapClear(bl, 0x3 ^ tlH)) {
-                        doneSomething = true;
-                        madeProgress = true;
-                    }
+    return madeProgress;
+}
 
-                    int tlV = board->vbitmapGet(tl) & 0xC;
-                    int trV = board->vbitmapGet(tr) & 0xC;
-                    if (board->vbitmapClear(tl, 0xC ^ trV)) {
-                        doneSomething = true;
-                        madeProgress = true;
-                    }
-                    if (board->vbitmapClear(tr, 0xC ^ tlV)) {
-                        doneSomething = true;
-                        madeProgress = true;
-                    }
+// Windows of consecutive clues longer than this are not counted; the
+// number of windows per run grows with the square of their length.
+constexpr int MAX_COUNT_SPAN = 12;
+
+// ruleTouchCounting: Every cell touches exactly one vertex of each vertex
+// row (and column) it spans. So for a window of consecutive clued vertices
+// along a vertex row, the cells strictly inside the window supply one touch
+// each per adjacent cell row, and the clue sum fixes how many of the (up to
+// four) cells just past the window ends must touch it. When that count is
+// tight, the boundary cells are forced. The same holds for vertex columns.
+bool ruleTouchCounting(Board* board) {
+    bool madeProgress = false;
+    int w = board->width;
+    int h = board->height;
+
+    // Boundary cells of a window along a line, each with its touching value
+    struct Boundary {
+        Cell* cell;
+        int touchValue;
+    };
+
+    auto countWindow = [&](bool horizontal, int line, int s, int t, int clueSum) {
+        InlineList<Boundary, 4> boundary;
+        int expected = clueSum;
+        for (int side = -1; side <= 0; side++) {
+            // Cell row (or column) line + side, which spans vertex line line
+            int across = line + side;
+            if (across < 0 || across >= (horizontal ? h : w)) {
+                continue;
+            }
+            expected -= t - s;
+            Cell* before = horizontal ? board->cellAt(s - 1, across) : board->cellAt(across, s - 1);
+            Cell* after = horizontal ? board->cellAt(t, across) : board->cellAt(across, t);
+            // Below or right of the line, the cell before the window touches it
+            // with a slash; above or left, with a backslash. The cell after
+            // the window is the mirror image.
+            int beforeValue = (side == 0) ? SLASH : BACKSLASH;
+            int afterValue = (side == 0) ? BACKSLASH : SLASH;
+            if (before->value == UNKNOWN) {
+                boundary.push_back({before, beforeValue});
+            } else if (before->value == beforeValue) {
+                expected--;
+            }
+            if (after->value == UNKNOWN) {
+                boundary.push_back({after, afterValue});
+            } else if (after->value == afterValue) {
+                expected--;
+            }
+        }
+        if (boundary.empty() || (expected != 0 && expected != boundary.size())) {
+            return;
+        }
+        for (auto& b : boundary) {
+            int value = (expected == 0) ? (SLASH + BACKSLASH - b.touchValue) : b.touchValue;
+            if (b.cell->value == UNKNOWN && !board->wouldFormLoop(b.cell, value)) {
+                board->placeValue(b.cell, value);
+                madeProgress = true;
+            }
+        }
+    };
+
+    auto countLine = [&](bool horizontal, int line) {
+        int length = horizontal ? w + 1 : h + 1;
+        auto clueAt = [&](int i) {
+            Vertex* vertex = horizontal ? board->vertexAt(i, line) : board->vertexAt(line, i);
+            return vertex->hasClue ? vertex->clue : -1;
+        };
+        for (int s = 0; s < length; s++) {
+            int clueSum = clueAt(s);
+            if (clueSum < 0) {
+                continue;
+            }
+            for (int t = s + 1; t < length && t < s + MAX_COUNT_SPAN; t++) {
+                int clue = clueAt(t);
+                if (clue < 0) {
+                    break;
                 }
+                clueSum += clue;
+                countWindow(horizontal, line, s, t, clueSum);
             }
         }
+    };
+
+    for (int vy = 0; vy <= h; vy++) {
+        countLine(true, vy);
+    }
+    for (int vx = 0; vx <= w; vx++) {
+        countLine(false, vx);
     }
 
     return madeProgress;
@@ -17,6 +17,9 @@ struct Rule {
 // Get the list of all rules
 std::vector<Rule> getRules();
 
+// touch_counting is opt-in; when enabled it runs after the getRules() list
+Rule getTouchCountingRule();
+
 // Individual rule functions
 bool ruleClueFinishB(Board* board);
 bool ruleClueFinishA(Board* board);
@@ -31,5 +34,6 @@ bool ruleDeadEndAvoidance(Board* board);
 bool ruleEquivalenceClasses(Board* board);
 bool ruleVBitmapPropagation(Board* board);
 bool ruleSimonUnified(Board* board);
+bool ruleTouchCounting(Board* board);
 
 #endif // RULES_H
@@ -0,0 +1,119 @@
+#include "schedule.h"
+#include "board.h"
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <numeric>
+#include <thread>
+
+double PredictCost(const std::string& givensString, int width, int height) {
+    GivensStatus status;
+    auto board = Board::fromGivens(width, height, givensString, status);
+    if (!board) {
+        return 0;
+    }
+    double area = (double)width * height;
+    double density = (double)board->getCluedVertices().size() / ((width + 1) * (height + 1));
+
+    SolveOptions options;
+    options.maxTier = 1;
+    Propagate(board.get(), options);
+    double unknown = board->getUnknownCount();
+
+    // Rules run over the whole board for every cell left to the tier 2/3
+    // rules and branching, and sparser clues leave more of those decisions
+    return area * (1 + unknown) * (1.5 - density);
+}
+
+namespace {
+
+// WorkQueue is one thread's share of the jobs, most expensive first. The
+// owner takes from the front; thieves take from the back.
+struct WorkQueue {
+    std::mutex mutex;
+    std::deque<int> jobs;
+
+    bool popFront(int& job) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (jobs.empty()) {
+            return false;
+        }
+        job = jobs.front();
+        jobs.pop_front();
+        return true;
+    }
+
+    bool popBack(int& job) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (jobs.empty()) {
+            return false;
+        }
+        job = jobs.back();
+        jobs.pop_back();
+        return true;
+    }
+};
+
+// runOnThreads calls body(t) for t in 0..numThreads-1, using the calling
+// thread for t = 0, and waits for all of them
+template <typename Body>
+void runOnThreads(int numThreads, const Body& body) {
+    std::vector<std::thread> threads;
+    for (int t = 1; t < numThreads; t++) {
+        threads.emplace_back(body, t);
+    }
+    body(0);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+}  // namespace
+
+std::vector<SolveResult> SolveParallel(const std::vector<SolveJob>& jobs, int numThreads, SolveFunc solveFn,
+                                       const SolveOptions& options) {
+    std::vector<SolveResult> results(jobs.size());
+    numThreads = std::max(1, std::min(numThreads, (int)jobs.size()));
+
+    // Predictions run tier-1 propagation, so they are spread over the threads too
+    std::vector<double> cost(jobs.size());
+    auto predict = [&](int self) {
+        for (size_t i = self; i < jobs.size(); i += numThreads) {
+            cost[i] = PredictCost(jobs[i].givens, jobs[i].width, jobs[i].height);
+        }
+    };
+    runOnThreads(numThreads, predict);
+    std::vector<int> order(jobs.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return cost[a] > cost[b]; });
+
+    // Deal round robin so every queue starts with one of the biggest jobs
+    std::vector<WorkQueue> queues(numThreads);
+    for (size_t i = 0; i < order.size(); i++) {
+        queues[i % numThreads].jobs.push_back(order[i]);
+    }
+
+    auto worker = [&](int self) {
+        int job;
+        for (;;) {
+            bool found = queues[self].popFront(job);
+            for (int k = 1; !found && k < numThreads; k++) {
+                found = queues[(self + k) % numThreads].popBack(job);
+            }
+            if (!found) {
+                return;
+            }
+            const SolveJob& j = jobs[job];
+            if (j.answerHint.empty()) {
+                results[job] = solveFn(j.givens, j.width, j.height, options);
+            } else {
+                SolveOptions hinted = options;
+                hinted.answerHint = j.answerHint;
+                results[job] = solveFn(j.givens, j.width, j.height, hinted);
+            }
+        }
+    };
+
+    runOnThreads(numThreads, worker);
+    return results;
+}
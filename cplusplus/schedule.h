@@ -0,0 +1,29 @@
+#ifndef SCHEDULE_H
+#define SCHEDULE_H
+
+#include "batch.h"
+#include "solver.h"
+#include <string>
+#include <vector>
+
+// SolveJob is one puzzle of a parallel run
+struct SolveJob {
+    std::string givens;
+    int width;
+    int height;
+    std::string answerHint;  // Passed as SolveOptions::answerHint when not empty
+};
+
+// PredictCost estimates the relative cost of solving a puzzle from cheap
+// features: its area, its clue density and how many cells tier-1
+// propagation leaves unknown. Only the ordering of the estimates matters.
+double PredictCost(const std::string& givensString, int width, int height);
+
+// SolveParallel solves jobs on numThreads threads. Jobs are dealt to the
+// threads in order of decreasing predicted cost, so the expensive puzzles
+// start first; a thread whose queue runs dry steals the cheapest job left
+// in another's queue. Results are in input order.
+std::vector<SolveResult> SolveParallel(const std::vector<SolveJob>& jobs, int numThreads, SolveFunc solveFn,
+                                       const SolveOptions& options);
+
+#endif // SCHEDULE_H
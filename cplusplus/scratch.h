@@ -0,0 +1,79 @@
+#ifndef SCRATCH_H
+#define SCRATCH_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// InlineList is a fixed-capacity list stored in place, for the handful of
+// cells or vertices around one vertex that rules collect while scanning
+template <typename T, int N>
+class InlineList {
+public:
+    void push_back(const T& item) { items[count++] = item; }
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+    bool contains(const T& item) const {
+        for (int i = 0; i < count; i++) {
+            if (items[i] == item) {
+                return true;
+            }
+        }
+        return false;
+    }
+    T& operator[](int i) { return items[i]; }
+    const T& operator[](int i) const { return items[i]; }
+    T* begin() { return items; }
+    T* end() { return items + count; }
+    const T* begin() const { return items; }
+    const T* end() const { return items + count; }
+
+private:
+    T items[N];
+    int count = 0;
+};
+
+// EpochGrid is board-sized scratch storage that a rule can reuse call
+// after call. Each entry carries the epoch it was written in; reset bumps
+// the epoch, so every entry reads as the fill value again in O(1).
+template <typename T>
+class EpochGrid {
+public:
+    // reset makes every entry read as fill, growing the grid to size if needed
+    void reset(int size, T fillValue) {
+        if ((int)values.size() < size) {
+            values.resize(size);
+            stamps.resize(size, 0);
+        }
+        fill = fillValue;
+        if (++epoch == 0) {
+            // The counter wrapped: old stamps could look current again
+            std::fill(stamps.begin(), stamps.end(), 0);
+            epoch = 1;
+        }
+    }
+
+    T get(int i) const { return stamps[i] == epoch ? values[i] : fill; }
+
+    T& operator[](int i) {
+        if (stamps[i] != epoch) {
+            stamps[i] = epoch;
+            values[i] = fill;
+        }
+        return values[i];
+    }
+
+private:
+    std::vector<T> values;
+    std::vector<uint32_t> stamps;
+    uint32_t epoch = 0;
+    T fill{};
+};
+
+// RuleScratch is the scratch storage owned by one board for its rules
+struct RuleScratch {
+    EpochGrid<uint8_t> vshapes;  // per-cell v-shape bits for vbitmap_propagation
+    EpochGrid<int> vertexSlot;   // per-vertex-root slot for SplitComponents and ComponentKey
+};
+
+#endif // SCRATCH_H
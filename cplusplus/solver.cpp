@@ -1,43 +1,166 @@
 #include "solver.h"
 #include "board.h"
 #include "rules.h"
+#include "propagate.h"
+#include "twosat.h"
+#include "arena.h"
+#include "valuemodel.h"
+#include "component.h"
+#include "symmetry.h"
 #include <vector>
 #include <algorithm>
 #include <memory>
+#include <cmath>
+
+// Work score charged when the large-board worklist propagator makes progress
+constexpr int LOCAL_PROPAGATION_SCORE = 2;
+
+// Work score charged for each cell forced by probing in BF
+constexpr int PROBE_SCORE = 4;
+
+// Work score charged for each cell forced by symmetry breaking in BF
+constexpr int SYMMETRY_SCORE = 1;
+
+// Work score and tier charged when the 2-SAT stage makes progress
+constexpr int TWO_SAT_SCORE = 10;
+constexpr int TWO_SAT_TIER = 2;
+
+// fireFirstRule applies the first rule that makes progress. In large-board
+// mode the worklist propagator is tried first as a tier-1 rule; with 2-SAT
+// enabled, the 2-SAT stage runs after every rule has stalled. A
+// contradiction either finds counts as progress so the caller can stop.
+static bool fireFirstRule(Board* board, const std::vector<Rule>& rules, LocalPropagator* propagator,
+                          TwoSatStage* twoSat, int& workScore, int& maxTierUsed) {
+    if (propagator && (propagator->run() || propagator->hasContradiction())) {
+        workScore += LOCAL_PROPAGATION_SCORE;
+        maxTierUsed = std::max(maxTierUsed, 1);
+        return true;
+    }
+    for (const auto& rule : rules) {
+        if (rule.func(board)) {
+            workScore += rule.score;
+            if (rule.tier > maxTierUsed) {
+                maxTierUsed = rule.tier;
+            }
+            return true;
+        }
+    }
+    if (twoSat && (twoSat->run() || twoSat->hasContradiction())) {
+        workScore += TWO_SAT_SCORE;
+        maxTierUsed = std::max(maxTierUsed, TWO_SAT_TIER);
+        return true;
+    }
+    return false;
+}
+
+// makePropagator returns the worklist propagator for large-board mode, or
+// nullptr when the plain rule loop is wanted
+static std::unique_ptr<LocalPropagator> makePropagator(Board* board, const SolveOptions& options) {
+    if (!options.largeBoard && options.propagationThreads <= 1) {
+        return nullptr;
+    }
+    return std::make_unique<LocalPropagator>(board, options.propagationThreads);
+}
+
+// makeTwoSat returns the 2-SAT stage if it is enabled and within the tier limit
+static std::unique_ptr<TwoSatStage> makeTwoSat(Board* board, const SolveOptions& options) {
+    if (!options.twoSat || options.maxTier < TWO_SAT_TIER) {
+        return nullptr;
+    }
+    return std::make_unique<TwoSatStage>(board);
+}
+
+// filterRules returns the rules up to the configured tier, followed by the
+// enabled opt-in rules. With parallel propagation, the v-bitmap rule is
+// replaced by its striped equivalent.
+static std::vector<Rule> filterRules(const SolveOptions& options) {
+    std::vector<Rule> rules = getRules();
+    if (options.touchCounting) {
+        rules.push_back(getTouchCountingRule());
+    }
+    std::vector<Rule> filteredRules;
+    for (const auto& rule : rules) {
+        if (rule.tier > options.maxTier) {
+            continue;
+        }
+        filteredRules.push_back(rule);
+        if (options.propagationThreads > 1 && rule.name == "vbitmap_propagation") {
+            int threads = options.propagationThreads;
+            filteredRules.back().func = [threads](Board* board) {
+                return ruleVBitmapPropagationStriped(board, threads);
+            };
+        }
+    }
+    return filteredRules;
+}
 
-// applyRulesUntilStuck applies rules repeatedly until no more progress
-std::pair<int, int> applyRulesUntilStuck(Board* board, const std::vector<Rule>& rules) {
+// RuleLoopResult is the outcome of applyRulesUntilStuck
+struct RuleLoopResult {
+    int workScore;
+    int maxTierUsed;
+    bool contradiction;
+};
+
+// cancelled reports whether the caller has asked the solve to stop
+static bool cancelled(const SolveOptions& options) {
+    return options.cancel && options.cancel->load(std::memory_order_relaxed);
+}
+
+// applyRulesUntilStuck applies rules repeatedly until no more progress.
+// Every firing makes real progress, so this always reaches a fixpoint
+// (unless the solve is cancelled).
+RuleLoopResult applyRulesUntilStuck(Board* board, const std::vector<Rule>& rules, const SolveOptions& options) {
     int totalWorkScore = 0;
     int maxTierUsed = 0;
-    int maxIterations = 1000;
 
-    for (int iteration = 0; iteration < maxIterations; iteration++) {
-        if (board->isSolved()) {
-            break;
-        }
+    auto propagator = makePropagator(board, options);
+    auto twoSat = makeTwoSat(board, options);
+    auto contradicted = [&]() {
+        return (propagator && propagator->hasContradiction()) || (twoSat && twoSat->hasContradiction());
+    };
 
-        if (!board->isValid()) {
+    while (!board->isSolved() && board->isValid() && !contradicted() && !cancelled(options)) {
+        if (!fireFirstRule(board, rules, propagator.get(), twoSat.get(), totalWorkScore, maxTierUsed)) {
             break;
         }
+    }
 
-        bool madeProgress = false;
-        for (const auto& rule : rules) {
-            if (rule.func(board)) {
-                totalWorkScore += rule.score;
-                if (rule.tier > maxTierUsed) {
-                    maxTierUsed = rule.tier;
-                }
-                madeProgress = true;
-                break;
-            }
+    return {totalWorkScore, maxTierUsed, contradicted()};
+}
+
+bool Propagate(Board* board, const SolveOptions& options) {
+    auto result = applyRulesUntilStuck(board, filterRules(options), options);
+    return !result.contradiction && board->isValid();
+}
+
+// branchScore rates a cell for branching by how constrained its clued
+// corners are
+static int branchScore(Board* board, Cell* cell) {
+    int score = 0;
+    Vertex *tl, *tr, *bl, *br;
+    board->getCellCorners(cell, &tl, &tr, &bl, &br);
+
+    Vertex* corners[] = {tl, tr, bl, br};
+    for (Vertex* corner : corners) {
+        if (!corner->hasClue) {
+            continue;
         }
 
-        if (!madeProgress) {
-            break;
+        auto [current, unknown] = board->countTouches(corner);
+        int clue = corner->clue;
+
+        int remainingNeeded = clue - current;
+        int remainingSlots = unknown;
+
+        if (remainingNeeded == remainingSlots) {
+            score += 100;
+        } else if (remainingNeeded == 0) {
+            score += 100;
+        } else if (remainingSlots > 0) {
+            score += 50 / remainingSlots;
         }
     }
-
-    return {totalWorkScore, maxTierUsed};
+    return score;
 }
 
 // pickBestCell picks the best cell for branching based on constraints
@@ -54,39 +177,102 @@ Cell* pickBestCell(Board* board) {
 
     std::vector<CellScore> scores;
     for (Cell* cell : unknownCells) {
-        int score = 0;
-        Vertex *tl, *tr, *bl, *br;
-        board->getCellCorners(cell, &tl, &tr, &bl, &br);
+        scores.push_back({cell, branchScore(board, cell)});
+    }
 
-        Vertex* corners[] = {tl, tr, bl, br};
-        for (Vertex* corner : corners) {
-            if (!corner || !corner->hasClue) {
-                continue;
-            }
+    std::sort(scores.begin(), scores.end(), [](const CellScore& a, const CellScore& b) {
+        return a.score > b.score;
+    });
 
-            auto [current, unknown] = board->countTouches(corner);
-            int clue = corner->clue;
+    return scores[0].cell;
+}
 
-            int remainingNeeded = clue - current;
-            int remainingSlots = unknown;
+// pickConfidentCell picks among the cells with the best branchScore the one
+// whose value the model predicts most confidently, so the first branch is
+// the likeliest to be right
+static Cell* pickConfidentCell(Board* board, const ValueModel& model) {
+    Cell* best = nullptr;
+    int bestScore = -1;
+    double bestConfidence = -1;
+    for (Cell* cell : board->getUnknownCells()) {
+        int score = branchScore(board, cell);
+        if (score < bestScore) {
+            continue;
+        }
+        double confidence = std::abs(model.slashProbability(board, cell) - 0.5);
+        if (score > bestScore || confidence > bestConfidence) {
+            best = cell;
+            bestScore = score;
+            bestConfidence = confidence;
+        }
+    }
+    return best;
+}
 
-            if (remainingNeeded == remainingSlots) {
-                score += 100;
-            } else if (remainingNeeded == 0) {
-                score += 100;
-            } else if (remainingSlots > 0) {
-                score += 50 / remainingSlots;
+// markAgainstAnswer flags every placed cell whose value differs from the hint
+static void markAgainstAnswer(Board* board, const std::vector<int>& hint, std::vector<uint8_t>& marks) {
+    for (int y = 0; y < board->height; y++) {
+        for (int x = 0; x < board->width; x++) {
+            int value = board->cellAt(x, y)->value;
+            if (value != UNKNOWN && value != hint[y * board->width + x]) {
+                marks[y * board->width + x] = 1;
             }
         }
-
-        scores.push_back({cell, score});
     }
+}
 
-    std::sort(scores.begin(), scores.end(), [](const CellScore& a, const CellScore& b) {
-        return a.score > b.score;
-    });
-
-    return scores[0].cell;
+// probeCells tries both values of every unknown cell, propagating each with
+// rules, and places the other value when one leads to a contradiction. The
+// arena's scratch record holds the node between trials. Returns false if
+// some cell has no consistent value; forced counts the cells placed.
+// With an answer hint (one value per cell), only the value differing from
+// the answer is tried, and refuting it places the answer's value. A cell
+// that an earlier consistent trial already set against the answer is
+// skipped: from the same node its own trial derives a subset of that one
+// and cannot fail. Placing a forced cell changes the node, so the marks
+// are cleared then.
+static bool probeCells(Board* board, SearchArena& arena, const std::vector<Rule>& rules,
+                       const SolveOptions& options, const std::vector<int>* hint, int& forced) {
+    forced = 0;
+    std::vector<uint8_t> dominated(hint ? hint->size() : 0, 0);
+    for (Cell* cell : board->getUnknownCells()) {
+        if (cell->value != UNKNOWN) {
+            continue;
+        }
+        if (hint && dominated[cell->y * board->width + cell->x]) {
+            continue;
+        }
+        arena.saveScratch(*board);
+        int consistent[2];
+        int numConsistent = 0;
+        for (int value : {SLASH, BACKSLASH}) {
+            if (hint && value == (*hint)[cell->y * board->width + cell->x]) {
+                consistent[numConsistent++] = value;
+                continue;
+            }
+            arena.restoreScratch(*board);
+            if (board->wouldFormLoop(cell, value) || !board->placeValue(cell, value)) {
+                continue;
+            }
+            auto result = applyRulesUntilStuck(board, rules, options);
+            if (!result.contradiction && board->isValid()) {
+                consistent[numConsistent++] = value;
+                if (hint) {
+                    markAgainstAnswer(board, *hint, dominated);
+                }
+            }
+        }
+        arena.restoreScratch(*board);
+        if (numConsistent == 0) {
+            return false;
+        }
+        if (numConsistent == 1) {
+            board->placeValue(cell, consistent[0]);
+            forced++;
+            std::fill(dominated.begin(), dominated.end(), 0);
+        }
+    }
+    return true;
 }
 
 // getValidValues returns valid values for a cell
@@ -105,10 +291,10 @@ std::vector<int> getValidValues(Board* board, Cell* cell) {
 
         int x = cell->x;
         int y = cell->y;
-        Vertex* tl = board->getVertex(x, y);
-        Vertex* tr = board->getVertex(x + 1, y);
-        Vertex* bl = board->getVertex(x, y + 1);
-        Vertex* br = board->getVertex(x + 1, y + 1);
+        Vertex* tl = board->vertexAt(x, y);
+        Vertex* tr = board->vertexAt(x + 1, y);
+        Vertex* bl = board->vertexAt(x, y + 1);
+        Vertex* br = board->vertexAt(x + 1, y + 1);
 
         std::vector<Vertex*> touches;
         if (value == SLASH) {
@@ -121,7 +307,7 @@ std::vector<int> getValidValues(Board* board, Cell* cell) {
         int priority = 0;
 
         for (Vertex* corner : touches) {
-            if (corner && corner->hasClue) {
+            if (corner->hasClue) {
                 auto [current, _] = board->countTouches(corner);
                 if (current >= corner->clue) {
                     isValid = false;
@@ -147,51 +333,316 @@ std::vector<int> getValidValues(Board* board, Cell* cell) {
     return result;
 }
 
-// stackEntry represents an entry on the backtracking stack
-struct StackEntry {
-    BoardState state;
-    int eliminatedValue;
+// decodeAnswerHint turns a solution string into one value per cell; it
+// returns an empty vector if the hint is missing or not a full solution
+static std::vector<int> decodeAnswerHint(const std::string& hint, int width, int height) {
+    if ((int)hint.size() != width * height) {
+        return {};
+    }
+    std::vector<int> values;
+    values.reserve(hint.size());
+    for (char c : hint) {
+        if (c != '/' && c != '\\') {
+            return {};
+        }
+        values.push_back(c == '/' ? SLASH : BACKSLASH);
+    }
+    return values;
+}
+
+// onAnswerPath reports whether every placed cell agrees with the hint
+static bool onAnswerPath(Board* board, const std::vector<int>& hint) {
+    if (hint.empty()) {
+        return false;
+    }
+    for (int y = 0; y < board->height; y++) {
+        for (int x = 0; x < board->width; x++) {
+            int value = board->cellAt(x, y)->value;
+            if (value != UNKNOWN && value != hint[y * board->width + x]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// cluesSatisfiable reports whether every clue can still get exactly its
+// number of touches
+static bool cluesSatisfiable(Board* board) {
+    for (Vertex* vertex : board->getCluedVertices()) {
+        auto [current, unknown] = board->countTouches(vertex);
+        if (current > vertex->clue || current + unknown < vertex->clue) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ComponentSearch is BF over independent components (see component.h).
+// Each node is propagated, its unknown cells are split into components, and
+// every component is looked up in the cache or solved by branching on its
+// own cells; the node's count is the product of the component counts.
+//
+// A cached count must depend only on the component's key. The full rules
+// see the whole board, so inside one of several components they could
+// reason through another component; those nodes use only the tier 1 rules,
+// which read a single clue or the vertex groups at a cell's corners. Nodes
+// whose cells are all the unknown cells of the board use every rule.
+class ComponentSearch {
+public:
+    ComponentSearch(Board* board, const std::vector<Rule>& rules, const std::vector<Rule>& localRules,
+                    const SolveOptions& options, const SolveOptions& localOptions)
+        : board(board), rules(rules), localRules(localRules), options(options), localOptions(localOptions),
+          cache(options.componentCache) {}
+
+    // solve counts the solutions over cells, which must hold every unknown
+    // cell sharing a vertex group with one of them; whole says they are all
+    // the unknown cells of the board. Values are per entry of cells.
+    ComponentResult solve(const std::vector<Cell*>& cells, bool whole);
+
+    int workScore = 0;
+    int maxTierUsed = 0;
+    int searchNodes = 0;
+    bool usedBranching = false;
+    bool stopped = false;  // the solve was cancelled
+
+private:
+    Board* board;
+    const std::vector<Rule>& rules;
+    const std::vector<Rule>& localRules;
+    const SolveOptions& options;
+    const SolveOptions& localOptions;
+    ComponentCache cache;
+    std::vector<std::vector<uint32_t>> frames;  // node snapshot per branching depth
+    int depth = 0;
+
+    ComponentResult branch(const std::vector<Cell*>& component, bool whole);
 };
 
-SolveResult SolveBF(const std::string& givensString, int width, int height, int maxTier) {
-    std::unique_ptr<Board> board;
-    try {
-        board = std::make_unique<Board>(width, height, givensString);
-    } catch (...) {
+ComponentResult ComponentSearch::solve(const std::vector<Cell*>& cells, bool whole) {
+    if (cancelled(options)) {
+        stopped = true;
+        return {};
+    }
+    searchNodes++;
+    auto [score, tierUsed, contradiction] =
+        applyRulesUntilStuck(board, whole ? rules : localRules, whole ? options : localOptions);
+    workScore += score + 2;
+    maxTierUsed = std::max(maxTierUsed, tierUsed);
+    if (contradiction || !cluesSatisfiable(board)) {
+        return {};
+    }
+
+    std::vector<Cell*> open;
+    for (Cell* cell : cells) {
+        if (cell->value == UNKNOWN) {
+            open.push_back(cell);
+        }
+    }
+    auto components = SplitComponents(board, open);
+
+    ComponentResult result;
+    result.count = 1;
+    std::vector<ComponentResult> parts;
+    for (const auto& component : components) {
+        std::vector<int> key = ComponentKey(board, component);
+        ComponentResult part;
+        if (const ComponentResult* cached = cache.find(key)) {
+            part = *cached;
+        } else {
+            part = branch(component, whole && components.size() == 1);
+            if (stopped) {
+                return {};
+            }
+            cache.insert(key, part);
+        }
+        if (part.count == 0) {
+            return {};
+        }
+        result.count = std::max(result.count, part.count);
+        parts.push_back(std::move(part));
+    }
+
+    // One solution of the node joins one solution of each component
+    std::vector<uint8_t> valueAt(board->width * board->height, UNKNOWN);
+    for (size_t i = 0; i < components.size(); i++) {
+        for (size_t j = 0; j < components[i].size(); j++) {
+            Cell* cell = components[i][j];
+            valueAt[cell->y * board->width + cell->x] = parts[i].values[j];
+        }
+    }
+    for (Cell* cell : cells) {
+        result.values.push_back(cell->value != UNKNOWN ? cell->value : valueAt[cell->y * board->width + cell->x]);
+    }
+    return result;
+}
+
+// branch tries each value of the most constrained cell of component and
+// adds up the counts, stopping at two, keeping the first solution found
+ComponentResult ComponentSearch::branch(const std::vector<Cell*>& component, bool whole) {
+    Cell* cell = component[0];
+    int bestScore = -1;
+    for (Cell* candidate : component) {
+        int score = branchScore(board, candidate);
+        if (score > bestScore) {
+            cell = candidate;
+            bestScore = score;
+        }
+    }
+
+    if ((int)frames.size() <= depth) {
+        frames.emplace_back(board->snapshotWords());
+    }
+    board->saveSnapshot(frames[depth].data());
+    depth++;
+    ComponentResult result;
+    for (int value : getValidValues(board, cell)) {
+        board->restoreSnapshot(frames[depth - 1].data());
+        usedBranching = true;
+        if (!board->placeValue(cell, value)) {
+            continue;
+        }
+        ComponentResult sub = solve(component, whole);
+        if (stopped) {
+            break;
+        }
+        if (sub.count > 0 && result.count == 0) {
+            result.values = std::move(sub.values);
+        }
+        result.count += sub.count;
+        if (result.count >= 2) {
+            result.count = 2;
+            break;
+        }
+    }
+    depth--;
+    board->restoreSnapshot(frames[depth].data());
+    return result;
+}
+
+// solveByComponents runs ComponentSearch from the root of board
+static SolveResult solveByComponents(Board* board, const std::vector<Rule>& rules,
+                                     const std::vector<Rule>& localRules, const SolveOptions& options,
+                                     const SolveOptions& localOptions) {
+    ComponentSearch search(board, rules, localRules, options, localOptions);
+    std::vector<Cell*> cells = board->getUnknownCells();
+    ComponentResult result = search.solve(cells, true);
+    if (search.stopped) {
+        return {"cancelled", "", search.workScore, search.maxTierUsed, search.searchNodes};
+    }
+
+    std::string status = result.count == 0 ? "unsolved" : result.count == 1 ? "solved" : "mult";
+    std::string solutionString = board->toSolutionString();
+    if (result.count > 0) {
+        for (size_t i = 0; i < cells.size(); i++) {
+            solutionString[cells[i]->y * board->width + cells[i]->x] = result.values[i] == SLASH ? '/' : '\\';
+        }
+    }
+    int maxTierUsed = search.usedBranching ? 3 : search.maxTierUsed;
+    return {status, solutionString, search.workScore, maxTierUsed, search.searchNodes};
+}
+
+SolveResult SolveBF(const std::string& givensString, int width, int height, const SolveOptions& options) {
+    GivensStatus givensStatus;
+    std::unique_ptr<Board> board = Board::fromGivens(width, height, givensString, givensStatus);
+    if (!board) {
         return {"unsolved", "", 0, 0};
     }
 
     // Filter rules by tier
-    std::vector<Rule> filteredRules;
-    for (const auto& rule : getRules()) {
-        if (rule.tier <= maxTier) {
-            filteredRules.push_back(rule);
-        }
+    std::vector<Rule> filteredRules = filterRules(options);
+
+    // Deep nodes and probes use only the cheap tier-1 clue and loop rules
+    SolveOptions cheapOptions = options;
+    cheapOptions.maxTier = 1;
+    cheapOptions.twoSat = false;
+    cheapOptions.touchCounting = false;
+    std::vector<Rule> cheapRules = filterRules(cheapOptions);
+
+    if (options.componentCache > 0) {
+        return solveByComponents(board.get(), filteredRules, cheapRules, options, cheapOptions);
+    }
+
+    std::vector<int> hint = decodeAnswerHint(options.answerHint, width, height);
+    std::vector<ClueSymmetry> symmetries;
+    if (options.symmetryBreaking) {
+        symmetries = FindClueSymmetries(board.get());
     }
 
     std::vector<std::string> solutions;
-    std::vector<StackEntry> stack;
-    stack.push_back({board->saveState(), -1});
+    SearchArena stack(*board);
+    std::vector<int> depths;
+    stack.push(*board);
+    depths.push_back(0);
     int totalWorkScore = 0;
     int maxTierUsed = 0;
     bool usedBranching = false;
     int pushPopScore = 0;
+    int searchNodes = 0;
+    int firstSolutionNodes = 0;
 
     while (!stack.empty() && solutions.size() < 2) {
-        StackEntry entry = std::move(stack.back());
-        stack.pop_back();
-        board->restoreState(entry.state);
+        if (cancelled(options)) {
+            return {"cancelled", "", totalWorkScore, maxTierUsed, searchNodes};
+        }
+        stack.pop(*board);
+        int depth = depths.back();
+        depths.pop_back();
         pushPopScore++;
-
-        // Apply rules
-        auto [workScore, tierUsed] = applyRulesUntilStuck(board.get(), filteredRules);
-        totalWorkScore += workScore;
-        if (tierUsed > maxTierUsed) {
-            maxTierUsed = tierUsed;
+        searchNodes++;
+
+        // Apply rules: all of them near the root, the cheap ones deeper down.
+        // Shallow nodes alternate rules and probing until neither progresses;
+        // nodes that still agree with an answer hint alternate rules and
+        // refuting the other value of each cell.
+        bool full = options.fullRulesDepth < 0 || depth <= options.fullRulesDepth;
+        bool dead = false;
+        bool guided = false;
+        while (true) {
+            auto [workScore, tierUsed, contradiction] =
+                applyRulesUntilStuck(board.get(), full ? filteredRules : cheapRules, full ? options : cheapOptions);
+            totalWorkScore += workScore;
+            if (tierUsed > maxTierUsed) {
+                maxTierUsed = tierUsed;
+            }
+            if (contradiction || !board->isValid()) {
+                dead = true;
+                break;
+            }
+            // Only lex-leaders survive; cells the lex order forces send the
+            // node back through the rules
+            if (!symmetries.empty()) {
+                int forced;
+                if (!BreakSymmetries(board.get(), symmetries, forced)) {
+                    dead = true;
+                    break;
+                }
+                if (forced > 0) {
+                    totalWorkScore += forced * SYMMETRY_SCORE;
+                    continue;
+                }
+            }
+            if (board->isSolved()) {
+                break;
+            }
+            guided = onAnswerPath(board.get(), hint);
+            if (!guided && depth > options.probeDepth) {
+                break;
+            }
+            int forced;
+            if (!probeCells(board.get(), stack, cheapRules, cheapOptions, guided ? &hint : nullptr, forced)) {
+                dead = true;
+                break;
+            }
+            if (forced == 0) {
+                break;
+            }
+            totalWorkScore += forced * PROBE_SCORE;
+            usedBranching = true;
         }
 
         // Check validity
-        if (!board->isValid()) {
+        if (dead) {
             continue;
         }
 
@@ -199,12 +650,20 @@ SolveResult SolveBF(const std::string& givensString, int width, int height, int
         if (board->isSolved()) {
             if (board->isValidSolution()) {
                 solutions.push_back(board->toSolutionString());
+                if (solutions.size() == 1) {
+                    firstSolutionNodes = searchNodes;
+                }
+                // A leader that a symmetry moves has a distinct mirror image
+                if (!FixedBySymmetries(board.get(), symmetries)) {
+                    solutions.push_back(board->toSolutionString());
+                }
             }
             continue;
         }
 
         // Choose cell for branching
-        Cell* cell = pickBestCell(board.get());
+        Cell* cell = options.valueModel ? pickConfidentCell(board.get(), *options.valueModel)
+                                        : pickBestCell(board.get());
         if (!cell) {
             continue;
         }
@@ -214,19 +673,29 @@ SolveResult SolveBF(const std::string& givensString, int width, int height, int
         if (validValues.empty()) {
             continue;
         }
+        // The model's likelier value goes first
+        if (options.valueModel && validValues.size() == 2) {
+            bool slashFirst = options.valueModel->slashProbability(board.get(), cell) >= 0.5;
+            validValues = {slashFirst ? SLASH : BACKSLASH, slashFirst ? BACKSLASH : SLASH};
+        }
+        // On the answer path the answer's value goes first
+        if (guided && validValues.size() == 2 && validValues[0] != hint[cell->y * width + cell->x]) {
+            std::swap(validValues[0], validValues[1]);
+        }
 
         // Push states for each valid value
-        BoardState savedState = board->saveState();
+        stack.saveScratch(*board);
         for (int i = (int)validValues.size() - 1; i >= 0; i--) {
             int value = validValues[i];
-            board->restoreState(savedState);
+            stack.restoreScratch(*board);
             if (board->placeValue(cell, value)) {
-                stack.push_back({board->saveState(), value});
+                stack.push(*board);
+                depths.push_back(depth + 1);
                 pushPopScore++;
                 usedBranching = true;
             }
         }
-        board->restoreState(savedState);
+        stack.restoreScratch(*board);
     }
 
     // Determine status
@@ -255,47 +724,34 @@ SolveResult SolveBF(const std::string& givensString, int width, int height, int
         maxTierUsed = 3;
     }
 
-    return {status, solutionString, totalWorkScore, maxTierUsed};
+    SolveResult result{status, solutionString, totalWorkScore, maxTierUsed, searchNodes};
+    result.firstSolutionNodes = firstSolutionNodes;
+    return result;
 }
 
-SolveResult SolvePR(const std::string& givensString, int width, int height, int maxTier) {
-    std::unique_ptr<Board> board;
-    try {
-        board = std::make_unique<Board>(width, height, givensString);
-    } catch (...) {
+SolveResult SolvePR(const std::string& givensString, int width, int height, const SolveOptions& options) {
+    GivensStatus givensStatus;
+    std::unique_ptr<Board> board = Board::fromGivens(width, height, givensString, givensStatus);
+    if (!board) {
         return {"unsolved", "", 0, 0};
     }
 
     // Filter rules by tier
-    std::vector<Rule> filteredRules;
-    for (const auto& rule : getRules()) {
-        if (rule.tier <= maxTier) {
-            filteredRules.push_back(rule);
-        }
-    }
+    std::vector<Rule> filteredRules = filterRules(options);
 
     int totalWorkScore = 0;
     int maxTierUsed = 0;
-    int maxIterations = 1000;
 
-    for (int iteration = 0; iteration < maxIterations; iteration++) {
-        if (board->isSolved()) {
-            break;
-        }
+    auto propagator = makePropagator(board.get(), options);
+    auto twoSat = makeTwoSat(board.get(), options);
 
-        bool madeProgress = false;
-        for (const auto& rule : filteredRules) {
-            if (rule.func(board.get())) {
-                totalWorkScore += rule.score;
-                if (rule.tier > maxTierUsed) {
-                    maxTierUsed = rule.tier;
-                }
-                madeProgress = true;
-                break;
-            }
+    while (!board->isSolved() && !(propagator && propagator->hasContradiction()) &&
+           !(twoSat && twoSat->hasContradiction())) {
+        if (cancelled(options)) {
+            return {"cancelled", "", totalWorkScore, maxTierUsed};
         }
-
-        if (!madeProgress) {
+        if (!fireFirstRule(board.get(), filteredRules, propagator.get(), twoSat.get(), totalWorkScore,
+                           maxTierUsed)) {
             break;
         }
     }
@@ -1,20 +1,50 @@
 #ifndef SOLVER_H
 #define SOLVER_H
 
+#include <atomic>
 #include <string>
 
+class Board;
+class ValueModel;
+
 // SolveResult contains the result of solving a puzzle
 struct SolveResult {
-    std::string status;  // "solved", "unsolved", or "mult"
+    std::string status;  // "solved", "unsolved", "mult", or "cancelled"
     std::string solutionString;
     int workScore;
     int maxTierUsed;
+    int searchNodes = 0;  // BF states taken off the search stack (0 for PR)
+    int firstSolutionNodes = 0;  // BF states taken off the stack up to the first solution
+    std::string engine{};  // Portfolio engine that produced the status (empty otherwise)
+};
+
+// SolveOptions selects rule tiers and optional engine modes
+struct SolveOptions {
+    int maxTier = 10;         // Maximum rule tier to use
+    bool largeBoard = false;  // Worklist propagation ahead of the rules, for very large boards
+    int propagationThreads = 1;  // >1 runs large-board propagation in parallel stripes
+    bool twoSat = false;      // 2-SAT over the binary constraints once the rules stall
+    bool touchCounting = false;  // Run the touch_counting rule after the standard rules
+    int fullRulesDepth = -1;  // BF nodes deeper than this run tier-1 rules only (-1: all depths)
+    int probeDepth = -1;      // BF nodes up to this depth also probe both values of every cell
+    int componentCache = 0;   // >0: BF solves independent components, caching up to this many results
+    bool symmetryBreaking = false;  // BF searches only the lex-leader of each orbit of the clue symmetries
+    std::string answerHint;  // BF: expected solution; refute its alternatives instead of searching blind
+    const ValueModel* valueModel = nullptr;  // BF breaks branching ties by model confidence, likeliest value first
+    std::string portfolio = "BF,BF2SAT,PR";  // Engines raced by SolvePortfolio, exhaustive reference first
+    bool portfolioFirst = false;  // SolvePortfolio returns the first definitive result, with its own scores
+    const std::atomic<bool>* cancel = nullptr;  // When set and true, the solve stops as "cancelled"
 };
 
 // SolveBF solves a puzzle using brute-force backtracking
-SolveResult SolveBF(const std::string& givensString, int width, int height, int maxTier);
+SolveResult SolveBF(const std::string& givensString, int width, int height, const SolveOptions& options);
 
 // SolvePR solves a puzzle using production rules only (no backtracking)
-SolveResult SolvePR(const std::string& givensString, int width, int height, int maxTier);
+SolveResult SolvePR(const std::string& givensString, int width, int height, const SolveOptions& options);
+
+// Propagate applies the rules up to options.maxTier until none makes
+// progress, without branching. Returns false if the board is shown to
+// have no solution.
+bool Propagate(Board* board, const SolveOptions& options);
 
 #endif // SOLVER_H
@@ -0,0 +1,205 @@
+// stress_search: search for Slants puzzles that are expensive for SolveBF,
+// to build a stress corpus of worst-case inputs.
+//
+// Each puzzle starts from a random loop-free solution with every clue
+// given, thinned greedily to a minimal clue set that BF still solves
+// uniquely. Simulated annealing then moves over clue sets of the same
+// solution (drop a clue, restore a clue, or swap one for another), keeping
+// only sets with a unique solution and scoring each by BF search nodes or
+// total work score. The best set found is written in the standard puzzle
+// format. Runs are reproducible from the seed.
+
+#include "generate.h"
+#include "solver.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Candidate is one clue set of the solution being searched, with its cost
+struct Candidate {
+    std::vector<int> clues;  // -1 for vertices without a clue
+    long long cost = -1;     // -1 when the clues do not give a unique solution
+    SolveResult result;
+};
+
+class StressSearch {
+public:
+    StressSearch(int width, int height, bool useNodes, std::mt19937& rng)
+        : width(width), height(height), useNodes(useNodes), rng(rng) {}
+
+    // run searches one solution for iterations annealing steps and returns
+    // the most expensive uniquely solvable clue set seen
+    Candidate run(const std::vector<int>& solution, int iterations);
+
+private:
+    int width;
+    int height;
+    bool useNodes;
+    std::mt19937& rng;
+    std::vector<int> fullClues;
+
+    void evaluate(Candidate& candidate);
+    Candidate minimize(std::vector<int> clues);
+    bool propose(const Candidate& from, Candidate& to);
+};
+
+void StressSearch::evaluate(Candidate& candidate) {
+    SolveOptions options;
+    candidate.result = SolveBF(EncodeGivens(candidate.clues), width, height, options);
+    if (candidate.result.status != "solved") {
+        candidate.cost = -1;
+    } else {
+        candidate.cost = useNodes ? candidate.result.searchNodes : candidate.result.workScore;
+    }
+}
+
+// minimize drops clues in random order as long as the solution stays unique
+Candidate StressSearch::minimize(std::vector<int> clues) {
+    std::vector<int> order(clues.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), rng);
+
+    Candidate current;
+    current.clues = clues;
+    evaluate(current);
+    for (int v : order) {
+        Candidate trial = current;
+        trial.clues[v] = -1;
+        evaluate(trial);
+        if (trial.cost >= 0) {
+            current = std::move(trial);
+        }
+    }
+    return current;
+}
+
+// propose builds a neighbouring clue set; returns false if the move is a no-op
+bool StressSearch::propose(const Candidate& from, Candidate& to) {
+    std::vector<int> given;
+    std::vector<int> missing;
+    for (int v = 0; v < (int)from.clues.size(); v++) {
+        (from.clues[v] >= 0 ? given : missing).push_back(v);
+    }
+    to.clues = from.clues;
+    int move = rng() % 3;
+    if (move == 0 && !given.empty()) {
+        to.clues[given[rng() % given.size()]] = -1;
+    } else if (move == 1 && !missing.empty()) {
+        int v = missing[rng() % missing.size()];
+        to.clues[v] = fullClues[v];
+    } else if (!given.empty() && !missing.empty()) {
+        int drop = given[rng() % given.size()];
+        int add = missing[rng() % missing.size()];
+        to.clues[drop] = -1;
+        to.clues[add] = fullClues[add];
+    } else {
+        return false;
+    }
+    return true;
+}
+
+Candidate StressSearch::run(const std::vector<int>& solution, int iterations) {
+    fullClues = SolutionClues(width, height, solution);
+    Candidate current = minimize(fullClues);
+    Candidate best = current;
+    if (current.cost < 0) {
+        return best;
+    }
+
+    // Costs span orders of magnitude, so moves are judged on log cost. The
+    // temperature falls linearly from a 30% worsening being likely accepted
+    // to almost pure hill climbing.
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    const double startTemp = 0.3;
+    const double endTemp = 0.01;
+    for (int i = 0; i < iterations; i++) {
+        double temp = startTemp + (endTemp - startTemp) * i / std::max(1, iterations - 1);
+        Candidate trial;
+        if (!propose(current, trial)) {
+            continue;
+        }
+        evaluate(trial);
+        if (trial.cost < 0) {
+            continue;
+        }
+        double delta = std::log(1.0 + trial.cost) - std::log(1.0 + current.cost);
+        if (delta >= 0 || uniform(rng) < std::exp(delta / temp)) {
+            current = std::move(trial);
+            if (current.cost > best.cost) {
+                best = current;
+            }
+        }
+    }
+    return best;
+}
+
+void printUsage(const char* progname) {
+    std::cerr << "Usage: " << progname << " [options]\n";
+    std::cerr << "Options:\n";
+    std::cerr << "  -w <width>    Board width (default 7)\n";
+    std::cerr << "  -ht <height>  Board height (default 7)\n";
+    std::cerr << "  -n <count>    Number of puzzles to output (default 10)\n";
+    std::cerr << "  -iters <n>    Annealing steps per puzzle (default 2000)\n";
+    std::cerr << "  -obj <name>   Objective: nodes (BF search nodes, default) or work (work score)\n";
+    std::cerr << "  -r <seed>     Random seed (default 1)\n";
+    std::cerr << "Puzzles are written to stdout in the standard testsuite format.\n";
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int width = 7;
+    int height = 7;
+    int count = 10;
+    int iterations = 2000;
+    std::string objective = "nodes";
+    unsigned seed = 1;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-w" && i + 1 < argc) {
+            width = std::stoi(argv[++i]);
+        } else if (arg == "-ht" && i + 1 < argc) {
+            height = std::stoi(argv[++i]);
+        } else if (arg == "-n" && i + 1 < argc) {
+            count = std::stoi(argv[++i]);
+        } else if (arg == "-iters" && i + 1 < argc) {
+            iterations = std::stoi(argv[++i]);
+        } else if (arg == "-obj" && i + 1 < argc) {
+            objective = argv[++i];
+        } else if (arg == "-r" && i + 1 < argc) {
+            seed = (unsigned)std::stoul(argv[++i]);
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (width < 1 || height < 1 || (objective != "nodes" && objective != "work")) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::mt19937 rng(seed);
+    StressSearch search(width, height, objective == "nodes", rng);
+    for (int n = 1; n <= count; n++) {
+        auto solution = GenerateSolution(width, height, rng);
+        Candidate best = search.run(solution, iterations);
+        if (best.cost < 0) {
+            std::cerr << "Puzzle " << n << ": full clue set is not unique, skipped\n";
+            continue;
+        }
+        int givens = (int)std::count_if(best.clues.begin(), best.clues.end(), [](int c) { return c >= 0; });
+        std::cout << "stress_" << width << "x" << height << "_" << n << "\t" << width << "\t" << height << "\t"
+                  << EncodeGivens(best.clues) << "\t" << SolutionString(solution) << "\t# givens=" << givens
+                  << " work_score=" << best.result.workScore << " nodes=" << best.result.searchNodes
+                  << " seed=" << seed << std::endl;
+    }
+    return 0;
+}
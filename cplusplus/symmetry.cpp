@@ -0,0 +1,144 @@
+#include "symmetry.h"
+#include <algorithm>
+
+// flipValue swaps SLASH and BACKSLASH and keeps UNKNOWN
+static int flipValue(int value) {
+    return value == UNKNOWN ? UNKNOWN : SLASH + BACKSLASH - value;
+}
+
+std::vector<ClueSymmetry> FindClueSymmetries(Board* board) {
+    int w = board->width;
+    int h = board->height;
+    std::vector<ClueSymmetry> symmetries;
+
+    // Each map is an optional transpose (square boards only) followed by
+    // optional mirrors of the two axes, on vertex coordinates
+    for (int transpose = 0; transpose <= (w == h ? 1 : 0); transpose++) {
+        for (int mirrorX = 0; mirrorX <= 1; mirrorX++) {
+            for (int mirrorY = 0; mirrorY <= 1; mirrorY++) {
+                if (!transpose && !mirrorX && !mirrorY) {
+                    continue;
+                }
+                auto map = [=](int vx, int vy, int& mx, int& my) {
+                    mx = transpose ? vy : vx;
+                    my = transpose ? vx : vy;
+                    if (mirrorX) {
+                        mx = w - mx;
+                    }
+                    if (mirrorY) {
+                        my = h - my;
+                    }
+                };
+
+                bool preserved = true;
+                for (int vy = 0; vy <= h && preserved; vy++) {
+                    for (int vx = 0; vx <= w && preserved; vx++) {
+                        int mx, my;
+                        map(vx, vy, mx, my);
+                        preserved = board->vertexAt(vx, vy)->clue == board->vertexAt(mx, my)->clue;
+                    }
+                }
+                if (!preserved) {
+                    continue;
+                }
+
+                // A cell maps to the cell spanned by the images of its
+                // corners. A slash keeps its orientation when the images of
+                // its ends are still bottom-left and top-right of each other.
+                ClueSymmetry symmetry;
+                int ax, ay, bx, by;
+                map(0, 1, ax, ay);
+                map(1, 0, bx, by);
+                symmetry.flips = (ax - bx) * (ay - by) > 0;
+                symmetry.image.resize(w * h);
+                for (int y = 0; y < h; y++) {
+                    for (int x = 0; x < w; x++) {
+                        map(x, y + 1, ax, ay);
+                        map(x + 1, y, bx, by);
+                        symmetry.image[y * w + x] = std::min(ay, by) * w + std::min(ax, bx);
+                    }
+                }
+                symmetries.push_back(std::move(symmetry));
+            }
+        }
+    }
+    return symmetries;
+}
+
+// breakSymmetry walks the cells in index order while the board agrees with
+// its image, as BreakSymmetries describes, for one symmetry
+static bool breakSymmetry(Board* board, const ClueSymmetry& symmetry, int& forced) {
+    int numCells = (int)symmetry.image.size();
+    for (int i = 0; i < numCells; i++) {
+        Cell* cell = board->cells[i].get();
+        Cell* imageCell = board->cells[symmetry.image[i]].get();
+        int value = cell->value;
+        int imageValue = symmetry.flips ? flipValue(imageCell->value) : imageCell->value;
+
+        if (cell == imageCell) {
+            if (!symmetry.flips) {
+                continue;
+            }
+            // The cell is compared with its own flip, so it decides the
+            // order: SLASH makes the board the smaller one
+            if (value == UNKNOWN) {
+                forced++;
+                return board->placeValue(cell, SLASH);
+            }
+            return value == SLASH;
+        }
+
+        if (value == UNKNOWN && imageValue == UNKNOWN) {
+            return true;
+        }
+        if (value == UNKNOWN) {
+            // Nothing is smaller than SLASH, so the cell must match
+            if (imageValue != SLASH) {
+                return true;
+            }
+            forced++;
+            if (!board->placeValue(cell, SLASH)) {
+                return false;
+            }
+            continue;
+        }
+        if (imageValue == UNKNOWN) {
+            // Nothing is larger than BACKSLASH, so the image must match
+            if (value != BACKSLASH) {
+                return true;
+            }
+            forced++;
+            if (!board->placeValue(imageCell, symmetry.flips ? SLASH : BACKSLASH)) {
+                return false;
+            }
+            continue;
+        }
+        if (value != imageValue) {
+            return value < imageValue;
+        }
+    }
+    return true;
+}
+
+bool BreakSymmetries(Board* board, const std::vector<ClueSymmetry>& symmetries, int& forced) {
+    forced = 0;
+    for (const ClueSymmetry& symmetry : symmetries) {
+        if (!breakSymmetry(board, symmetry, forced)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool FixedBySymmetries(Board* board, const std::vector<ClueSymmetry>& symmetries) {
+    for (const ClueSymmetry& symmetry : symmetries) {
+        int numCells = (int)symmetry.image.size();
+        for (int i = 0; i < numCells; i++) {
+            int imageValue = board->cells[symmetry.image[i]]->value;
+            if (board->cells[i]->value != (symmetry.flips ? flipValue(imageValue) : imageValue)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,35 @@
+#ifndef SYMMETRY_H
+#define SYMMETRY_H
+
+#include "board.h"
+#include <vector>
+
+// A rotation or reflection of the board that maps every clue onto an equal
+// clue also maps every solution onto a solution, so the solutions fall into
+// orbits. Searching only the lexicographically smallest solution of each
+// orbit (its lex-leader, reading cells in index order with SLASH before
+// BACKSLASH) visits each orbit once, and a leader that some symmetry moves
+// stands for at least two solutions.
+
+// ClueSymmetry is a non-identity symmetry of the board's clues
+struct ClueSymmetry {
+    std::vector<int> image;  // per cell index, the index of the cell it maps to
+    bool flips;              // the map turns SLASH into BACKSLASH and back
+};
+
+// FindClueSymmetries returns the rotations and reflections (only the
+// half-turn and the two mirrors on non-square boards) under which the clues
+// are unchanged, in position and value
+std::vector<ClueSymmetry> FindClueSymmetries(Board* board);
+
+// BreakSymmetries checks that the placed cells can still extend to a
+// lex-leader under every symmetry and places the cells the lex order
+// forces. Returns false if no lex-leader is possible; forced counts the
+// cells placed.
+bool BreakSymmetries(Board* board, const std::vector<ClueSymmetry>& symmetries, int& forced);
+
+// FixedBySymmetries reports whether a solved board is its own image under
+// every symmetry, i.e. whether its orbit is a single solution
+bool FixedBySymmetries(Board* board, const std::vector<ClueSymmetry>& symmetries);
+
+#endif // SYMMETRY_H
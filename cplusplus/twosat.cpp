@@ -0,0 +1,329 @@
+#include "twosat.h"
+#include <algorithm>
+
+// Loop-closing groups larger than this are skipped; their pairwise clauses
+// would cost quadratic time for constraints the rules already cover.
+constexpr int MAX_LOOP_GROUP = 32;
+
+// Forced literals are checked against this many target components at a
+// time, one bit each, so the closure needs at most 64 words per component.
+constexpr int CLOSURE_BLOCK_WORDS = 64;
+
+TwoSatStage::TwoSatStage(Board* b) : board(b), contradiction(false), numComps(0) {}
+
+int TwoSatStage::literal(Cell* cell, int value) {
+    int var = varOfRoot.get(board->getCellEquivRoot(cell));
+    return 2 * var + (value == SLASH ? 0 : 1);
+}
+
+// collectVariables numbers the classes of the unknown cells and adds units
+// for the classes whose value is already known
+void TwoSatStage::collectVariables() {
+    varOfRoot.reset(board->width * board->height, -1);
+    for (Cell* cell : board->getUnknownCells()) {
+        int root = board->getCellEquivRoot(cell);
+        if (varOfRoot.get(root) >= 0) {
+            continue;
+        }
+        varOfRoot[root] = (int)varCell.size();
+        varCell.push_back(cell);
+        int known = board->getEquivalenceClassValue(cell);
+        if (known != UNKNOWN) {
+            int lit = literal(cell, known);
+            clauses.push_back({lit, lit});
+        }
+    }
+}
+
+// collectClueClauses adds the binary consequences of each clue, in terms of
+// literals meaning "this cell touches the clue"
+void TwoSatStage::collectClueClauses() {
+    for (Vertex* vertex : board->getCluedVertices()) {
+        int touches = 0;
+        InlineList<int, 4> lits;
+        for (auto& adj : board->getAdjacentCellsForVertex(vertex)) {
+            if (adj.cell->value == UNKNOWN) {
+                lits.push_back(literal(adj.cell, adj.slashTouches ? SLASH : BACKSLASH));
+            } else if ((adj.cell->value == SLASH && adj.slashTouches) ||
+                       (adj.cell->value == BACKSLASH && adj.backslashTouches)) {
+                touches++;
+            }
+        }
+
+        int numUnknown = lits.size();
+        int needed = vertex->clue - touches;
+        if (needed < 0 || needed > numUnknown) {
+            contradiction = true;
+            return;
+        }
+        if (numUnknown == 0) {
+            continue;
+        }
+        for (int i = 0; i < numUnknown; i++) {
+            if (needed == 0) {
+                clauses.push_back({lits[i] ^ 1, lits[i] ^ 1});
+            } else if (needed == numUnknown) {
+                clauses.push_back({lits[i], lits[i]});
+            }
+            for (int j = i + 1; j < numUnknown; j++) {
+                if (needed == 1) {
+                    clauses.push_back({lits[i] ^ 1, lits[j] ^ 1});
+                }
+                if (needed == numUnknown - 1) {
+                    clauses.push_back({lits[i], lits[j]});
+                }
+            }
+        }
+    }
+}
+
+// collectLoopClauses forbids diagonals that close a loop on their own and
+// pairs of diagonals that would join the same two vertex groups
+void TwoSatStage::collectLoopClauses() {
+    diagonals.clear();
+    for (Cell* cell : board->getUnknownCells()) {
+        int x = cell->x;
+        int y = cell->y;
+        for (int value : {SLASH, BACKSLASH}) {
+            int a = (value == SLASH) ? board->getVertexRoot(x, y + 1) : board->getVertexRoot(x, y);
+            int b = (value == SLASH) ? board->getVertexRoot(x + 1, y) : board->getVertexRoot(x + 1, y + 1);
+            int lit = literal(cell, value);
+            if (a == b) {
+                clauses.push_back({lit ^ 1, lit ^ 1});
+            } else {
+                diagonals.push_back({(long long)std::min(a, b) << 32 | std::max(a, b), lit});
+            }
+        }
+    }
+
+    std::sort(diagonals.begin(), diagonals.end());
+    for (size_t start = 0, end; start < diagonals.size(); start = end) {
+        end = start + 1;
+        while (end < diagonals.size() && diagonals[end].first == diagonals[start].first) {
+            end++;
+        }
+        if (end - start > MAX_LOOP_GROUP) {
+            continue;
+        }
+        for (size_t i = start; i < end; i++) {
+            for (size_t j = i + 1; j < end; j++) {
+                int a = diagonals[i].second;
+                int b = diagonals[j].second;
+                if (a != (b ^ 1)) {
+                    clauses.push_back({a ^ 1, b ^ 1});
+                }
+            }
+        }
+    }
+}
+
+// buildGraph turns each clause (a or b) into the edges not-a -> b and not-b -> a
+void TwoSatStage::buildGraph() {
+    int numNodes = 2 * (int)varCell.size();
+    edgeStart.assign(numNodes + 1, 0);
+    for (auto [a, b] : clauses) {
+        edgeStart[(a ^ 1) + 1]++;
+        edgeStart[(b ^ 1) + 1]++;
+    }
+    for (int u = 0; u < numNodes; u++) {
+        edgeStart[u + 1] += edgeStart[u];
+    }
+    edges.resize(edgeStart[numNodes]);
+    std::vector<int> fill(edgeStart.begin(), edgeStart.end() - 1);
+    for (auto [a, b] : clauses) {
+        edges[fill[a ^ 1]++] = b;
+        edges[fill[b ^ 1]++] = a;
+    }
+}
+
+// findComponents runs Tarjan's algorithm with an explicit call stack.
+// Components are numbered as they complete, so every edge leads to a
+// component with the same or a lower number.
+void TwoSatStage::findComponents() {
+    int numNodes = 2 * (int)varCell.size();
+    comp.assign(numNodes, -1);
+    index.assign(numNodes, -1);
+    lowlink.assign(numNodes, 0);
+    onStack.assign(numNodes, 0);
+    stack.clear();
+    callStack.clear();
+    numComps = 0;
+    int counter = 0;
+
+    auto visit = [&](int u) {
+        index[u] = lowlink[u] = counter++;
+        stack.push_back(u);
+        onStack[u] = 1;
+        callStack.push_back({u, edgeStart[u]});
+    };
+
+    for (int s = 0; s < numNodes; s++) {
+        if (index[s] >= 0) {
+            continue;
+        }
+        visit(s);
+        while (!callStack.empty()) {
+            int u = callStack.back().first;
+            if (callStack.back().second < edgeStart[u + 1]) {
+                int v = edges[callStack.back().second++];
+                if (index[v] < 0) {
+                    visit(v);
+                } else if (onStack[v]) {
+                    lowlink[u] = std::min(lowlink[u], index[v]);
+                }
+                continue;
+            }
+            if (lowlink[u] == index[u]) {
+                int v;
+                do {
+                    v = stack.back();
+                    stack.pop_back();
+                    onStack[v] = 0;
+                    comp[v] = numComps;
+                } while (v != u);
+                numComps++;
+            }
+            callStack.pop_back();
+            if (!callStack.empty()) {
+                int parent = callStack.back().first;
+                lowlink[parent] = std::min(lowlink[parent], lowlink[u]);
+            }
+        }
+    }
+}
+
+// findForcedValues returns, per variable, the value every solution of the
+// clauses gives it, or UNKNOWN. Only a literal that comes first in the
+// component order can be forced (it is true in the canonical assignment),
+// and it is forced exactly when the component of its negation reaches it.
+std::vector<int> TwoSatStage::findForcedValues() {
+    int numNodes = 2 * (int)varCell.size();
+    std::vector<int> forced(varCell.size(), UNKNOWN);
+
+    // Nodes grouped by component, for walking the condensation
+    std::vector<int> compStart(numComps + 1, 0);
+    for (int u = 0; u < numNodes; u++) {
+        compStart[comp[u] + 1]++;
+    }
+    for (int c = 0; c < numComps; c++) {
+        compStart[c + 1] += compStart[c];
+    }
+    std::vector<int> compNodes(numNodes);
+    std::vector<int> fill(compStart.begin(), compStart.end() - 1);
+    for (int u = 0; u < numNodes; u++) {
+        compNodes[fill[comp[u]]++] = u;
+    }
+
+    // Target bit for each component holding a candidate literal
+    std::vector<int> target(numComps, -1);
+    std::vector<int> candidates;
+    int numTargets = 0;
+    for (int u = 0; u < numNodes; u++) {
+        if (comp[u] < comp[u ^ 1]) {
+            candidates.push_back(u);
+            if (target[comp[u]] < 0) {
+                target[comp[u]] = numTargets++;
+            }
+        }
+    }
+
+    const int blockBits = CLOSURE_BLOCK_WORDS * 64;
+    std::vector<uint64_t> reach;
+    for (int base = 0; base < numTargets; base += blockBits) {
+        int words = std::min(CLOSURE_BLOCK_WORDS, (numTargets - base + 63) / 64);
+        reach.assign((size_t)numComps * words, 0);
+        for (int c = 0; c < numComps; c++) {
+            uint64_t* row = &reach[(size_t)c * words];
+            int t = target[c] - base;
+            if (target[c] >= 0 && t < blockBits && t >= 0) {
+                row[t / 64] |= 1ULL << (t % 64);
+            }
+            for (int k = compStart[c]; k < compStart[c + 1]; k++) {
+                int u = compNodes[k];
+                for (int e = edgeStart[u]; e < edgeStart[u + 1]; e++) {
+                    int d = comp[edges[e]];
+                    if (d == c) {
+                        continue;
+                    }
+                    const uint64_t* succ = &reach[(size_t)d * words];
+                    for (int w = 0; w < words; w++) {
+                        row[w] |= succ[w];
+                    }
+                }
+            }
+        }
+        for (int u : candidates) {
+            int t = target[comp[u]] - base;
+            if (t < 0 || t >= blockBits) {
+                continue;
+            }
+            const uint64_t* row = &reach[(size_t)comp[u ^ 1] * words];
+            if (row[t / 64] & (1ULL << (t % 64))) {
+                forced[u / 2] = (u & 1) ? BACKSLASH : SLASH;
+            }
+        }
+    }
+    return forced;
+}
+
+bool TwoSatStage::run() {
+    if (contradiction) {
+        return false;
+    }
+    clauses.clear();
+    varCell.clear();
+
+    collectVariables();
+    if (varCell.empty()) {
+        return false;
+    }
+    collectClueClauses();
+    if (contradiction) {
+        return false;
+    }
+    collectLoopClauses();
+    buildGraph();
+    findComponents();
+
+    int numVars = (int)varCell.size();
+    for (int v = 0; v < numVars; v++) {
+        if (comp[2 * v] == comp[2 * v + 1]) {
+            contradiction = true;
+            return false;
+        }
+    }
+
+    std::vector<int> forced = findForcedValues();
+    bool madeProgress = false;
+
+    // Place the forced classes before merging, while the class roots still
+    // match the variable numbering
+    for (Cell* cell : board->getUnknownCells()) {
+        int value = forced[varOfRoot.get(board->getCellEquivRoot(cell))];
+        if (value == UNKNOWN) {
+            continue;
+        }
+        if (board->wouldFormLoop(cell, value)) {
+            contradiction = true;
+            return false;
+        }
+        board->placeValue(cell, value);
+        madeProgress = true;
+    }
+
+    // Classes whose SLASH literals share a component take the same value
+    std::vector<int> anchor(numComps, -1);
+    for (int v = 0; v < numVars; v++) {
+        if (forced[v] != UNKNOWN) {
+            continue;
+        }
+        int c = comp[2 * v];
+        if (anchor[c] < 0) {
+            anchor[c] = v;
+        } else if (board->markCellsEquivalent(varCell[anchor[c]], varCell[v])) {
+            madeProgress = true;
+        }
+    }
+
+    return madeProgress;
+}
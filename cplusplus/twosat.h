@@ -0,0 +1,76 @@
+#ifndef TWOSAT_H
+#define TWOSAT_H
+
+#include "board.h"
+#include "scratch.h"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// TwoSatStage collects the binary constraints of the current position into
+// an implication graph and solves it as 2-SAT. There is one variable per
+// equivalence class of unknown cells (true means SLASH). The clauses are:
+//
+//   - units for classes whose value is already known, for clues that need
+//     all or none of their unknown cells, and for diagonals that would join
+//     a vertex group to itself;
+//   - at-most-one pairs for clues needing one more touch, and at-least-one
+//     pairs for clues needing all but one of their unknown cells (both for a
+//     clue needing one of two);
+//   - loop-closing pairs: two diagonals that would each join the same two
+//     vertex groups cannot both be placed.
+//
+// Tarjan's algorithm finds the strongly connected components. A variable in
+// the same component as its negation proves the position has no solution;
+// classes whose SLASH literals share a component are merged. A literal l is
+// forced when not-l reaches l, which is read off a reachability closure over
+// the condensation, computed in blocks of 64-bit words.
+class TwoSatStage {
+public:
+    explicit TwoSatStage(Board* board);
+
+    // run solves the current binary constraints and returns true if a cell
+    // was placed or two equivalence classes were merged
+    bool run();
+
+    // hasContradiction reports whether the constraints were unsatisfiable.
+    // Once set, run does nothing.
+    bool hasContradiction() const { return contradiction; }
+
+private:
+    Board* board;
+    bool contradiction;
+
+    // Variables, indexed by cell class root
+    EpochGrid<int> varOfRoot;
+    std::vector<Cell*> varCell;
+
+    // Clauses as literal pairs; literal 2v is "class v is SLASH", 2v+1 its negation
+    std::vector<std::pair<int, int>> clauses;
+
+    // Loop-closing candidates: (vertex group pair key, literal)
+    std::vector<std::pair<long long, int>> diagonals;
+
+    // Implication graph in CSR form
+    std::vector<int> edgeStart;
+    std::vector<int> edges;
+
+    // Tarjan state; comp numbers components sinks first
+    std::vector<int> comp;
+    std::vector<int> index;
+    std::vector<int> lowlink;
+    std::vector<int> stack;
+    std::vector<uint8_t> onStack;
+    std::vector<std::pair<int, int>> callStack;
+    int numComps;
+
+    void collectVariables();
+    void collectClueClauses();
+    void collectLoopClauses();
+    void buildGraph();
+    void findComponents();
+    std::vector<int> findForcedValues();
+    int literal(Cell* cell, int value);
+};
+
+#endif // TWOSAT_H
@@ -0,0 +1,103 @@
+#include "valuemodel.h"
+#include <fstream>
+#include <sstream>
+
+// Key layout: 3 bits per corner clue (0-4, or 5 for no clue) for the
+// top-left, top-right, bottom-left and bottom-right corners, then 2 bits
+// per neighbour (0 unknown, 1 SLASH, 2 BACKSLASH, 3 outside) for the cells
+// above, left, right and below.
+constexpr uint32_t NO_CLUE_CODE = 5;
+constexpr int NEIGHBOUR_SHIFT = 12;
+constexpr uint32_t OUTSIDE_CODE = 3;
+
+bool ValueModel::parseKey(const std::string& text, uint32_t& key) {
+    static const std::string neighbourCodes = "usbx";
+    if (text.size() != 9 || text[4] != ':') {
+        return false;
+    }
+    key = 0;
+    for (int i = 0; i < 4; i++) {
+        char c = text[i];
+        if (c != '.' && (c < '0' || c > '4')) {
+            return false;
+        }
+        uint32_t code = (c == '.') ? NO_CLUE_CODE : (uint32_t)(c - '0');
+        key |= code << (3 * i);
+    }
+    for (int i = 0; i < 4; i++) {
+        size_t code = neighbourCodes.find(text[5 + i]);
+        if (code == std::string::npos) {
+            return false;
+        }
+        key |= (uint32_t)code << (NEIGHBOUR_SHIFT + 2 * i);
+    }
+    return true;
+}
+
+bool ValueModel::load(const std::string& path, std::string& error) {
+    std::ifstream in(path);
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+    table.clear();
+    std::string line;
+    int lineNum = 0;
+    while (std::getline(in, line)) {
+        lineNum++;
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream fields(line);
+        std::string keyText;
+        long long slash, total;
+        uint32_t key;
+        if (!(fields >> keyText >> slash >> total) || !parseKey(keyText, key) || slash < 0 || total < slash) {
+            error = path + ":" + std::to_string(lineNum) + ": malformed entry";
+            return false;
+        }
+        // Laplace smoothing keeps rare contexts away from certainty
+        table[key] = (float)((slash + 1.0) / (total + 2.0));
+    }
+    if (table.empty()) {
+        error = path + " has no entries";
+        return false;
+    }
+    return true;
+}
+
+double ValueModel::lookup(uint32_t key) const {
+    auto it = table.find(key);
+    if (it == table.end()) {
+        // The trainer keeps off-board neighbours in every context, so only
+        // the neighbours on the board are reset to unknown
+        uint32_t fallback = key;
+        for (int i = 0; i < 4; i++) {
+            int shift = NEIGHBOUR_SHIFT + 2 * i;
+            if (((key >> shift) & 3) != OUTSIDE_CODE) {
+                fallback &= ~(3u << shift);
+            }
+        }
+        it = table.find(fallback);
+    }
+    return (it == table.end()) ? 0.5 : it->second;
+}
+
+double ValueModel::slashProbability(Board* board, Cell* cell) const {
+    int x = cell->x;
+    int y = cell->y;
+    Vertex* corners[4] = {board->vertexAt(x, y), board->vertexAt(x + 1, y), board->vertexAt(x, y + 1),
+                          board->vertexAt(x + 1, y + 1)};
+    Cell* neighbours[4] = {board->cellAt(x, y - 1), board->cellAt(x - 1, y), board->cellAt(x + 1, y),
+                           board->cellAt(x, y + 1)};
+    uint32_t key = 0;
+    for (int i = 0; i < 4; i++) {
+        uint32_t code = corners[i]->hasClue ? (uint32_t)corners[i]->clue : NO_CLUE_CODE;
+        key |= code << (3 * i);
+    }
+    for (int i = 0; i < 4; i++) {
+        // UNKNOWN, SLASH, BACKSLASH and OUTSIDE are 0-3, matching the key codes
+        key |= (uint32_t)neighbours[i]->value << (NEIGHBOUR_SHIFT + 2 * i);
+    }
+    return lookup(key);
+}
@@ -0,0 +1,33 @@
+#ifndef VALUEMODEL_H
+#define VALUEMODEL_H
+
+#include "board.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+// ValueModel is a lookup table from a cell's local context to the
+// probability that the cell is SLASH, trained from solved corpora by
+// train_value_model.py. The context is the clue on each of the cell's four
+// corners and the state of its four orthogonal neighbours (unknown, SLASH,
+// BACKSLASH or off the board). Contexts missing from the table fall back
+// to the same corners with every neighbour on the board unknown, then to
+// 0.5.
+class ValueModel {
+public:
+    // load reads a model file; on failure error says why
+    bool load(const std::string& path, std::string& error);
+
+    size_t size() const { return table.size(); }
+
+    // slashProbability returns P(cell is SLASH) in the current position
+    double slashProbability(Board* board, Cell* cell) const;
+
+private:
+    std::unordered_map<uint32_t, float> table;
+
+    static bool parseKey(const std::string& text, uint32_t& key);
+    double lookup(uint32_t key) const;
+};
+
+#endif // VALUEMODEL_H
@@ -0,0 +1,95 @@
+#include "verify.h"
+#include "board.h"
+#include "solver.h"
+
+const char* answerStatusName(AnswerStatus status) {
+    switch (status) {
+        case AnswerStatus::VALID:
+            return "valid";
+        case AnswerStatus::NO_ANSWER:
+            return "no_answer";
+        case AnswerStatus::BAD_GIVENS:
+            return "bad_givens";
+        case AnswerStatus::BAD_LENGTH:
+            return "bad_length";
+        case AnswerStatus::BAD_CHARACTER:
+            return "bad_character";
+        case AnswerStatus::CLUE_MISMATCH:
+            return "clue_mismatch";
+        case AnswerStatus::LOOP:
+            return "loop";
+        case AnswerStatus::NOT_UNIQUE:
+            return "not_unique";
+    }
+    return "unknown";
+}
+
+int AnswerVerifier::find(int v) {
+    while (parent[v] != v) {
+        parent[v] = parent[parent[v]];
+        v = parent[v];
+    }
+    return v;
+}
+
+AnswerStatus AnswerVerifier::check(const std::string& givens, int width, int height,
+                                   const std::string& answer, bool requireUnique) {
+    if (answer.empty()) {
+        return AnswerStatus::NO_ANSWER;
+    }
+    if (width <= 0 || height <= 0) {
+        return AnswerStatus::BAD_GIVENS;
+    }
+    auto geometry = BoardGeometry::get(width, height);
+
+    clues.assign(geometry->numVertices, -1);
+    auto status = Board::decodeGivens(givens, geometry->numVertices,
+                                      [&](int v, int clue) { clues[v] = (int8_t)clue; });
+    if (status != GivensStatus::OK) {
+        return AnswerStatus::BAD_GIVENS;
+    }
+    if ((int)answer.size() != geometry->numCells) {
+        return AnswerStatus::BAD_LENGTH;
+    }
+
+    touches.assign(geometry->numVertices, 0);
+    parent.resize(geometry->numVertices);
+    for (int v = 0; v < geometry->numVertices; v++) {
+        parent[v] = v;
+    }
+
+    for (int c = 0; c < geometry->numCells; c++) {
+        // Corners are top-left, top-right, bottom-left, bottom-right
+        const auto& corners = geometry->cellCorners[c];
+        int v1, v2;
+        if (answer[c] == '/') {
+            v1 = corners[2];
+            v2 = corners[1];
+        } else if (answer[c] == '\\') {
+            v1 = corners[0];
+            v2 = corners[3];
+        } else {
+            return AnswerStatus::BAD_CHARACTER;
+        }
+        touches[v1]++;
+        touches[v2]++;
+
+        int r1 = find(v1);
+        int r2 = find(v2);
+        if (r1 == r2) {
+            return AnswerStatus::LOOP;
+        }
+        parent[r1] = r2;
+    }
+
+    for (int v = 0; v < geometry->numVertices; v++) {
+        if (clues[v] >= 0 && touches[v] != clues[v]) {
+            return AnswerStatus::CLUE_MISMATCH;
+        }
+    }
+
+    if (requireUnique && SolveBF(givens, width, height, SolveOptions()).status == "mult") {
+        return AnswerStatus::NOT_UNIQUE;
+    }
+    return AnswerStatus::VALID;
+}
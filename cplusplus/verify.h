@@ -0,0 +1,42 @@
+#ifndef VERIFY_H
+#define VERIFY_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// AnswerStatus is the outcome of checking a stored answer
+enum class AnswerStatus {
+    VALID,
+    NO_ANSWER,       // the record has no answer to check
+    BAD_GIVENS,      // givens could not be decoded for this size
+    BAD_LENGTH,      // answer does not have one character per cell
+    BAD_CHARACTER,   // answer contains something other than '/' or '\'
+    CLUE_MISMATCH,   // some clue is not met
+    LOOP,            // the diagonals form a closed loop
+    NOT_UNIQUE,      // valid, but the puzzle has another solution
+};
+
+const char* answerStatusName(AnswerStatus status);
+
+// AnswerVerifier checks answers against givens in one linear pass: touch
+// counts per clued vertex and a union-find over vertices for loops. Buffers
+// are reused from record to record, so one verifier should be used for a
+// whole stream.
+class AnswerVerifier {
+public:
+    // check verifies answer for the puzzle. With requireUnique, a valid answer
+    // is also confirmed to be the only solution by a BF search that stops at
+    // the second solution it finds.
+    AnswerStatus check(const std::string& givens, int width, int height, const std::string& answer,
+                       bool requireUnique);
+
+private:
+    std::vector<int8_t> clues;
+    std::vector<uint8_t> touches;
+    std::vector<int> parent;
+
+    int find(int v);
+};
+
+#endif // VERIFY_H
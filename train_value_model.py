@@ -0,0 +1,142 @@
+#!/usr/bin/env python3
+"""
+Train a value-ordering model for the C++ BF solver from solved corpora.
+
+Every cell of every record with an answer is one training sample. Its
+context is the clue (or no clue) on each of its four corners and the state
+of its four orthogonal neighbours: unknown, /, \\ or off the board. During
+a search most neighbours are still unknown, so each cell is counted once for
+every subset of its neighbours taken as known (16 samples per cell). Each
+sample is also counted in its horizontal, vertical and 180-degree mirror
+images, flipping the orientations where a mirror swaps them.
+
+The output is a text table, one context per line:
+
+    <key> <slash count> <total count>
+
+A key is the four corner clues (top-left, top-right, bottom-left,
+bottom-right; 0-4 or '.') then ':' and the four neighbours (up, left,
+right, down; 'u' unknown, 's' slash, 'b' backslash, 'x' outside), e.g.
+"1..3:usbx". solve_puzzles -vm <file> loads it for BF value ordering and
+cell selection.
+
+Usage:
+    python train_value_model.py [-o model.txt] [--min-count N] <corpus_file> [...]
+
+Example:
+    python train_value_model.py -o value_model.txt testsuites/GEN_*_testsuite.txt puzzledata/*.txt
+"""
+
+import argparse
+import sys
+from collections import defaultdict
+
+from slants_board import parse_puzzle_line
+
+NO_CLUE = '.'
+UNKNOWN = 'u'
+SLASH = 's'
+BACKSLASH = 'b'
+OUTSIDE = 'x'
+
+FLIP_VALUE = {SLASH: BACKSLASH, BACKSLASH: SLASH, UNKNOWN: UNKNOWN, OUTSIDE: OUTSIDE}
+
+
+def decode_givens(givens, num_vertices):
+    """Decode run-length givens into a list of clue characters, or None if malformed."""
+    clues = []
+    for char in givens:
+        if char.isdigit():
+            clues.append(char)
+        elif char.islower():
+            clues.extend([NO_CLUE] * (ord(char) - ord('a') + 1))
+    return clues if len(clues) == num_vertices else None
+
+
+def mirrors(corners, neighbours, value):
+    """
+    Yield the context and value under the four mirror symmetries.
+
+    A left-right or top-bottom mirror turns / into \\; doing both (a
+    half-turn) keeps every orientation.
+    """
+    tl, tr, bl, br = corners
+    up, left, right, down = neighbours
+    yield corners, neighbours, value
+    # Left-right mirror
+    yield ((tr, tl, br, bl), (FLIP_VALUE[up], FLIP_VALUE[right], FLIP_VALUE[left], FLIP_VALUE[down]),
+           FLIP_VALUE[value])
+    # Top-bottom mirror
+    yield ((bl, br, tl, tr), (FLIP_VALUE[down], FLIP_VALUE[left], FLIP_VALUE[right], FLIP_VALUE[up]),
+           FLIP_VALUE[value])
+    # Half-turn
+    yield (br, bl, tr, tl), (down, right, left, up), value
+
+
+def count_record(puzzle, counts):
+    """Add the samples of one solved record to counts; returns False if it has no usable answer."""
+    width, height = puzzle['width'], puzzle['height']
+    answer = puzzle['answer']
+    clues = decode_givens(puzzle['givens'], (width + 1) * (height + 1))
+    if clues is None or len(answer) != width * height or any(c not in '/\\' for c in answer):
+        return False
+
+    def value_at(x, y):
+        if x < 0 or y < 0 or x >= width or y >= height:
+            return OUTSIDE
+        return SLASH if answer[y * width + x] == '/' else BACKSLASH
+
+    def clue_at(vx, vy):
+        return clues[vy * (width + 1) + vx]
+
+    for y in range(height):
+        for x in range(width):
+            corners = (clue_at(x, y), clue_at(x + 1, y), clue_at(x, y + 1), clue_at(x + 1, y + 1))
+            actual = (value_at(x, y - 1), value_at(x - 1, y), value_at(x + 1, y), value_at(x, y + 1))
+            value = value_at(x, y)
+            for mask in range(16):
+                neighbours = tuple(n if (mask >> i) & 1 or n == OUTSIDE else UNKNOWN
+                                   for i, n in enumerate(actual))
+                for c, n, v in mirrors(corners, neighbours, value):
+                    entry = counts[''.join(c) + ':' + ''.join(n)]
+                    entry[0] += v == SLASH
+                    entry[1] += 1
+    return True
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Train a value-ordering model from solved corpora')
+    parser.add_argument('corpus', nargs='+', help='Puzzle files with answers')
+    parser.add_argument('-o', '--output', type=str, default='value_model.txt',
+                        help='Model file to write (default: value_model.txt)')
+    parser.add_argument('--min-count', type=int, default=1,
+                        help='Drop contexts seen fewer times than this (default: 1)')
+    args = parser.parse_args()
+
+    counts = defaultdict(lambda: [0, 0])
+    records = 0
+    skipped = 0
+    for path in args.corpus:
+        with open(path) as f:
+            for line in f:
+                puzzle = parse_puzzle_line(line)
+                if not puzzle:
+                    continue
+                if count_record(puzzle, counts):
+                    records += 1
+                else:
+                    skipped += 1
+
+    kept = sorted(key for key, (_, total) in counts.items() if total >= args.min_count)
+    with open(args.output, 'w') as f:
+        f.write(f"# slants value model: {records} records, {len(kept)} contexts\n")
+        for key in kept:
+            slash, total = counts[key]
+            f.write(f"{key} {slash} {total}\n")
+
+    print(f"{records} records ({skipped} without a usable answer), {len(kept)} contexts -> {args.output}")
+    return 0 if records else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())